@@ -0,0 +1,398 @@
+#include "Adaptive.h"
+#include <string.h>
+
+// list indices; the same four lists are named after each policy
+#define T1 0
+#define T2 1
+#define B1 2
+#define B2 3
+#define A1IN T1
+#define AM T2
+#define A1OUT B1
+#define STACK_S 0
+#define QUEUE_Q 1
+#define GHOSTS 2
+
+// LIRS status
+#define LIR 0
+#define HIR 1
+
+// policy name -> adaptivePolicy (-1 if the algorithm is not one of them)
+int get_adaptive_policy(const char *algorithm) {
+    if (strcmp(algorithm, "arc") == 0) return ADAPTIVE_ARC;
+    if (strcmp(algorithm, "2q") == 0) return ADAPTIVE_2Q;
+    if (strcmp(algorithm, "lirs") == 0) return ADAPTIVE_LIRS;
+    return -1;
+}
+
+static inline size_t home_slot(adaptive_cache *cache, uint64_t page) {
+    page ^= page >> 33;
+    page *= 0xff51afd7ed558ccdULL;
+    page ^= page >> 33;
+    return page & cache->hash_mask;
+}
+
+// slot holding the page, or the empty slot where it would go
+static size_t find_slot(adaptive_cache *cache, uint64_t page) {
+    size_t slot = home_slot(cache, page);
+    while (cache->hash[slot] != -1 && cache->entries[cache->hash[slot]].page != page) {
+        slot = (slot + 1) & cache->hash_mask;
+    }
+    return slot;
+}
+
+static int new_entry(adaptive_cache *cache, uint64_t page) {
+    int e = cache->free_entries[--cache->free_count];
+    cache->entries[e].page = page;
+    cache->entries[e].frame = -1;
+    cache->entries[e].list = -1;
+    cache->entries[e].in_stack = false;
+    cache->entries[e].in_queue = false;
+    cache->hash[find_slot(cache, page)] = e;
+    return e;
+}
+
+// forgets the page: removes it from the hash (backward shift, so probes never meet a hole) and
+// gives the entry back to the pool
+static void delete_entry(adaptive_cache *cache, int e) {
+    size_t hole = find_slot(cache, cache->entries[e].page);
+    size_t slot = hole;
+    while (true) {
+        slot = (slot + 1) & cache->hash_mask;
+        if (cache->hash[slot] == -1) break;
+        size_t home = home_slot(cache, cache->entries[cache->hash[slot]].page);
+        // the entry may move into the hole only if its home is not between the hole and its slot
+        if (((slot - home) & cache->hash_mask) >= ((slot - hole) & cache->hash_mask)) {
+            cache->hash[hole] = cache->hash[slot];
+            hole = slot;
+        }
+    }
+    cache->hash[hole] = -1;
+    cache->free_entries[cache->free_count++] = e;
+}
+
+static inline void list_push(adaptive_cache *cache, int list, int e) {
+    recency_touch(cache->lists[list], e);
+    cache->length[list]++;
+}
+
+static inline void list_remove(adaptive_cache *cache, int list, int e) {
+    recency_remove(cache->lists[list], e);
+    cache->length[list]--;
+}
+
+static inline int list_oldest(adaptive_cache *cache, int list) {
+    return recency_least_recent(cache->lists[list]);
+}
+
+// moves an ARC or 2Q entry to the most recent end of another list
+static inline void move_to(adaptive_cache *cache, int e, int list) {
+    if (cache->entries[e].list != -1) list_remove(cache, cache->entries[e].list, e);
+    list_push(cache, list, e);
+    cache->entries[e].list = list;
+}
+
+// initialize the policy for a memory of `frames` frames
+adaptive_cache* init_adaptive_cache(adaptivePolicy policy, size_t frames) {
+    adaptive_cache *cache = (adaptive_cache*) calloc(1, sizeof(adaptive_cache));
+    size_t pool = 2 * frames + 2; // resident pages, at most `frames` ghosts and the one being loaded
+    cache->policy = policy;
+    cache->frames = frames;
+    cache->entries = (adaptive_entry*) malloc(pool * sizeof(adaptive_entry));
+    cache->free_entries = (int*) malloc(pool * sizeof(int));
+    for (size_t i = 0; i < pool; i++) {
+        cache->free_entries[i] = pool - 1 - i;
+    }
+    cache->free_count = pool;
+    cache->frame_entry = (int*) malloc(frames * sizeof(int));
+    for (size_t i = 0; i < frames; i++) {
+        cache->frame_entry[i] = -1;
+    }
+
+    size_t slots = 1;
+    while (slots < 2 * pool) slots <<= 1;
+    cache->hash = (int*) malloc(slots * sizeof(int));
+    memset(cache->hash, 0xff, slots * sizeof(int));
+    cache->hash_mask = slots - 1;
+
+    for (int l = 0; l < ADAPTIVE_LISTS; l++) {
+        cache->lists[l] = init_recency_list(pool);
+    }
+    cache->incoming = -1;
+    cache->in_limit = frames / 4 > 0 ? frames / 4 : 1;
+    cache->out_limit = policy == ADAPTIVE_2Q ? (frames / 2 > 0 ? frames / 2 : 1) : frames;
+    size_t hir_limit = frames / 100 > 0 ? frames / 100 : 1;
+    cache->lir_limit = frames > hir_limit ? frames - hir_limit : 0;
+    cache->history_interval = 1;
+    return cache;
+}
+
+/* ============ LIRS ============ */
+
+// removes the HIR entries at the bottom of S, so the bottom is always a LIR page. Resident HIR pages
+// stay in Q; ghosts are forgotten
+static void lirs_prune(adaptive_cache *cache) {
+    int e;
+    while ((e = list_oldest(cache, STACK_S)) != -1 && cache->entries[e].list == HIR) {
+        list_remove(cache, STACK_S, e);
+        cache->entries[e].in_stack = false;
+        if (cache->entries[e].frame == -1) {
+            list_remove(cache, GHOSTS, e);
+            delete_entry(cache, e);
+        }
+    }
+}
+
+// the LIR page at the bottom of S becomes a resident HIR page at the end of Q
+static void lirs_demote_bottom(adaptive_cache *cache) {
+    int e = list_oldest(cache, STACK_S);
+    list_remove(cache, STACK_S, e);
+    cache->entries[e].in_stack = false;
+    cache->entries[e].list = HIR;
+    list_push(cache, QUEUE_Q, e);
+    cache->entries[e].in_queue = true;
+    cache->lir_count--;
+    lirs_prune(cache);
+}
+
+// a HIR page with a recent enough reuse (it is still in S) becomes LIR and takes the place of the oldest LIR page
+static void lirs_promote(adaptive_cache *cache, int e) {
+    if (cache->entries[e].in_queue) {
+        list_remove(cache, QUEUE_Q, e);
+        cache->entries[e].in_queue = false;
+    }
+    cache->entries[e].list = LIR;
+    recency_touch(cache->lists[STACK_S], e);
+    cache->lir_count++;
+    lirs_demote_bottom(cache);
+}
+
+static void lirs_hit(adaptive_cache *cache, int e) {
+    adaptive_entry *entry = &cache->entries[e];
+    if (entry->list == LIR) {
+        bool bottom = list_oldest(cache, STACK_S) == e;
+        recency_touch(cache->lists[STACK_S], e);
+        if (bottom) lirs_prune(cache);
+    } else if (entry->in_stack && cache->lir_limit > 0) {
+        lirs_promote(cache, e);
+    } else {
+        if (!entry->in_stack) {
+            list_push(cache, STACK_S, e);
+            entry->in_stack = true;
+        } else {
+            recency_touch(cache->lists[STACK_S], e);
+        }
+        recency_touch(cache->lists[QUEUE_Q], e);
+    }
+}
+
+static void lirs_load(adaptive_cache *cache, int e) {
+    adaptive_entry *entry = &cache->entries[e];
+    if (cache->lir_count < cache->lir_limit) { // the first pages fill the LIR set
+        entry->list = LIR;
+        if (!entry->in_stack) cache->length[STACK_S]++;
+        recency_touch(cache->lists[STACK_S], e);
+        entry->in_stack = true;
+        cache->lir_count++;
+    } else if (entry->in_stack && cache->lir_limit > 0) { // a ghost still in S
+        lirs_promote(cache, e);
+    } else {
+        entry->list = HIR;
+        if (!entry->in_stack) cache->length[STACK_S]++;
+        recency_touch(cache->lists[STACK_S], e);
+        entry->in_stack = true;
+        list_push(cache, QUEUE_Q, e);
+        entry->in_queue = true;
+    }
+}
+
+// the resident HIR page at the front of Q; it stays in S as a ghost if it is there
+static int lirs_victim(adaptive_cache *cache) {
+    int e = list_oldest(cache, QUEUE_Q);
+    if (e == -1) { // only with a single frame and no HIR page resident
+        e = list_oldest(cache, STACK_S);
+        list_remove(cache, STACK_S, e);
+        cache->entries[e].in_stack = false;
+        cache->lir_count--;
+        return e;
+    }
+    list_remove(cache, QUEUE_Q, e);
+    cache->entries[e].in_queue = false;
+    return e;
+}
+
+/* ============ ACCESSES ============ */
+
+// the page in the frame was referenced again
+void adaptive_hit(adaptive_cache *cache, unsigned int frame) {
+    int e = cache->frame_entry[frame];
+    switch (cache->policy) {
+        case ADAPTIVE_ARC:
+            move_to(cache, e, T2);
+            break;
+        case ADAPTIVE_2Q:
+            if (cache->entries[e].list == AM) recency_touch(cache->lists[AM], e); // hits in A1in are ignored
+            break;
+        case ADAPTIVE_LIRS:
+            lirs_hit(cache, e);
+            break;
+    }
+}
+
+// the page is not resident: finds out whether it is a ghost and, for ARC, adapts p
+void adaptive_miss(adaptive_cache *cache, uint64_t page) {
+    size_t slot = find_slot(cache, page);
+    int e = cache->hash[slot];
+    cache->incoming = e;
+    cache->forget_victim = false;
+    if (cache->policy != ADAPTIVE_ARC) return;
+
+    double b1 = cache->length[B1], b2 = cache->length[B2];
+    if (e != -1 && cache->entries[e].list == B1) { // recency was undervalued: T1 grows
+        cache->p += b2 > b1 ? b2 / b1 : 1;
+        if (cache->p > cache->frames) cache->p = cache->frames;
+    } else if (e != -1) { // frequency was undervalued: T2 grows
+        cache->p -= b1 > b2 ? b1 / b2 : 1;
+        if (cache->p < 0) cache->p = 0;
+    } else if (cache->length[T1] + cache->length[B1] == cache->frames) {
+        if (cache->length[T1] < cache->frames) {
+            int oldest = list_oldest(cache, B1);
+            list_remove(cache, B1, oldest);
+            delete_entry(cache, oldest);
+        } else {
+            cache->forget_victim = true; // T1 alone fills the memory: its oldest page is not remembered
+        }
+    } else if (cache->length[T1] + cache->length[T2] + cache->length[B1] + cache->length[B2] >= 2 * cache->frames) {
+        int oldest = list_oldest(cache, B2);
+        list_remove(cache, B2, oldest);
+        delete_entry(cache, oldest);
+    }
+}
+
+// frame to be evicted (memory is full); the evicted page becomes a ghost or is forgotten
+unsigned int adaptive_victim(adaptive_cache *cache) {
+    int e;
+    switch (cache->policy) {
+        case ADAPTIVE_ARC: {
+            size_t t1 = cache->length[T1];
+            bool incoming_b2 = cache->incoming != -1 && cache->entries[cache->incoming].list == B2;
+            bool from_t1 = t1 > 0 && ((incoming_b2 && t1 == cache->p) || t1 > cache->p || cache->length[T2] == 0);
+            e = list_oldest(cache, from_t1 ? T1 : T2);
+            if (cache->forget_victim) {
+                list_remove(cache, T1, e);
+                cache->entries[e].list = -1;
+            } else {
+                move_to(cache, e, from_t1 ? B1 : B2);
+            }
+            break;
+        }
+        case ADAPTIVE_2Q:
+            if (cache->length[A1IN] > cache->in_limit || cache->length[AM] == 0) {
+                e = list_oldest(cache, A1IN);
+                move_to(cache, e, A1OUT);
+            } else {
+                e = list_oldest(cache, AM);
+                list_remove(cache, AM, e);
+                cache->entries[e].list = -1;
+            }
+            break;
+        case ADAPTIVE_LIRS:
+        default:
+            e = lirs_victim(cache);
+            if (cache->entries[e].in_stack) {
+                list_push(cache, GHOSTS, e);
+                cache->entries[e].list = HIR;
+            }
+            break;
+    }
+
+    unsigned int frame = cache->entries[e].frame;
+    cache->frame_entry[frame] = -1;
+    cache->entries[e].frame = -1;
+    bool ghost = cache->policy == ADAPTIVE_LIRS ? cache->entries[e].in_stack : cache->entries[e].list != -1;
+    if (!ghost) delete_entry(cache, e);
+    return frame;
+}
+
+// the page was brought into the frame
+void adaptive_load(adaptive_cache *cache, unsigned int frame, uint64_t page) {
+    int e = cache->incoming;
+    if (e == -1) {
+        e = new_entry(cache, page);
+    }
+    cache->entries[e].frame = frame;
+    cache->frame_entry[frame] = e;
+
+    switch (cache->policy) {
+        case ADAPTIVE_ARC:
+            move_to(cache, e, cache->incoming == -1 ? T1 : T2);
+            break;
+        case ADAPTIVE_2Q:
+            move_to(cache, e, cache->incoming == -1 ? A1IN : AM);
+            while (cache->length[A1OUT] > cache->out_limit) {
+                int oldest = list_oldest(cache, A1OUT);
+                list_remove(cache, A1OUT, oldest);
+                delete_entry(cache, oldest);
+            }
+            break;
+        case ADAPTIVE_LIRS:
+            if (cache->incoming != -1) list_remove(cache, GHOSTS, e);
+            lirs_load(cache, e);
+            while (cache->length[GHOSTS] > cache->out_limit) {
+                int oldest = list_oldest(cache, GHOSTS);
+                list_remove(cache, GHOSTS, oldest);
+                list_remove(cache, STACK_S, oldest);
+                delete_entry(cache, oldest);
+            }
+            break;
+    }
+    cache->incoming = -1;
+    cache->forget_victim = false;
+}
+
+// the value each policy tunes or grows as it runs: ARC's p, the size of 2Q's A1in and the size of LIRS's stack S
+double adaptive_parameter(adaptive_cache *cache) {
+    switch (cache->policy) {
+        case ADAPTIVE_ARC: return cache->p;
+        case ADAPTIVE_2Q: return cache->length[A1IN];
+        case ADAPTIVE_LIRS: return cache->length[STACK_S];
+    }
+    return 0;
+}
+
+const char* adaptive_parameter_name(adaptive_cache *cache) {
+    switch (cache->policy) {
+        case ADAPTIVE_ARC: return "p";
+        case ADAPTIVE_2Q: return "A1in size";
+        case ADAPTIVE_LIRS: return "stack S size";
+    }
+    return "";
+}
+
+// samples the parameter at virtual time `now` (accesses simulated so far), if a sample is due
+void adaptive_record(adaptive_cache *cache, unsigned long now) {
+    if (cache->history_length > 0 && now < cache->history_time[cache->history_length - 1] + cache->history_interval) return;
+    if (cache->history_length == ADAPTIVE_HISTORY) {
+        for (size_t i = 0; i < ADAPTIVE_HISTORY / 2; i++) {
+            cache->history_time[i] = cache->history_time[2 * i + 1];
+            cache->history_value[i] = cache->history_value[2 * i + 1];
+        }
+        cache->history_length = ADAPTIVE_HISTORY / 2;
+        cache->history_interval *= 2;
+    }
+    cache->history_time[cache->history_length] = now;
+    cache->history_value[cache->history_length] = adaptive_parameter(cache);
+    cache->history_length++;
+}
+
+void free_adaptive_cache(adaptive_cache *cache) {
+    if (cache == NULL) return;
+    for (int l = 0; l < ADAPTIVE_LISTS; l++) {
+        free_recency_list(cache->lists[l]);
+    }
+    free(cache->entries);
+    free(cache->free_entries);
+    free(cache->frame_entry);
+    free(cache->hash);
+    free(cache);
+}
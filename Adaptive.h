@@ -0,0 +1,80 @@
+#ifndef ADAPTIVE_H
+#define ADAPTIVE_H
+
+#include <stdlib.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include "Recency.h"
+
+#define ADAPTIVE_LISTS 4
+#define ADAPTIVE_HISTORY 32
+
+typedef enum { ADAPTIVE_ARC, ADAPTIVE_2Q, ADAPTIVE_LIRS } adaptivePolicy;
+
+// a page known to the policy: resident (it has a frame) or a ghost, remembered after its eviction
+typedef struct {
+    uint64_t page;
+    int frame; // -1 for ghosts
+    int list; // ARC and 2Q: list holding the entry; LIRS: LIR or HIR status
+    bool in_stack; // LIRS: entry is in the recency stack S
+    bool in_queue; // LIRS: entry is in the queue of resident HIR pages
+} adaptive_entry;
+
+// scan-resistant policies (ARC, 2Q and LIRS). Resident pages and ghosts share one pool of entries,
+// found by page number through an open addressing hash; every list is a recency_list over the pool,
+// so each access costs O(1)
+//   ARC: lists T1, T2 (resident) and B1, B2 (ghosts); p is the target size of T1
+//   2Q: A1in (FIFO of new pages), Am (LRU of pages seen again) and A1out (ghosts of A1in)
+//   LIRS: stack S, queue Q of resident HIR pages and the ghosts in order of eviction
+typedef struct {
+    adaptivePolicy policy;
+    size_t frames;
+    adaptive_entry *entries;
+    int *free_entries;
+    size_t free_count;
+    int *frame_entry; // entry held by each frame
+    int *hash; // page -> entry (-1 if the slot is empty)
+    size_t hash_mask;
+    recency_list *lists[ADAPTIVE_LISTS];
+    size_t length[ADAPTIVE_LISTS];
+    int incoming; // ghost entry of the page being loaded (-1 if the page is new)
+    bool forget_victim; // ARC: the next victim is dropped instead of becoming a ghost
+    double p; // ARC: target size of T1
+    size_t in_limit; // 2Q: Kin, the size A1in may reach before it gives up frames
+    size_t out_limit; // 2Q and LIRS: ghosts kept
+    size_t lir_limit; // LIRS: frames reserved for LIR pages
+    size_t lir_count;
+
+    // samples of adaptive_parameter over the run; when full, every other sample is dropped and the
+    // interval doubles, so they stay evenly spaced
+    unsigned long history_time[ADAPTIVE_HISTORY];
+    double history_value[ADAPTIVE_HISTORY];
+    size_t history_length;
+    unsigned long history_interval;
+} adaptive_cache;
+
+/* ============ FUNCTIONS ============ */
+
+int get_adaptive_policy(const char *algorithm);
+
+adaptive_cache* init_adaptive_cache(adaptivePolicy policy, size_t frames);
+
+void adaptive_hit(adaptive_cache *cache, unsigned int frame);
+
+void adaptive_miss(adaptive_cache *cache, uint64_t page);
+
+unsigned int adaptive_victim(adaptive_cache *cache);
+
+void adaptive_load(adaptive_cache *cache, unsigned int frame, uint64_t page);
+
+double adaptive_parameter(adaptive_cache *cache);
+
+const char* adaptive_parameter_name(adaptive_cache *cache);
+
+void adaptive_record(adaptive_cache *cache, unsigned long now);
+
+void free_adaptive_cache(adaptive_cache *cache);
+
+/* =================================== */
+
+#endif
@@ -0,0 +1,108 @@
+#include "Allocation.h"
+#include <stdio.h>
+#include <string.h>
+
+// parses the description given to alloc= (see allocation_config); returns false if it is malformed
+bool parse_allocation_config(const char *spec, allocation_config *config) {
+    memset(config, 0, sizeof(*config));
+    config->lower = PFF_DEFAULT_LOWER;
+    config->upper = PFF_DEFAULT_UPPER;
+    config->tau = WORKING_SET_DEFAULT_TAU;
+
+    if (strcmp(spec, "pff") == 0 || strncmp(spec, "pff:", 4) == 0) {
+        config->policy = ALLOCATION_PFF;
+        if (spec[3] == ':' && sscanf(spec + 4, "%lf,%lf", &config->lower, &config->upper) != 2) return false;
+        return config->lower >= 0 && config->upper > config->lower;
+    }
+    if (strcmp(spec, "ws") == 0 || strncmp(spec, "ws:", 3) == 0) {
+        config->policy = ALLOCATION_WORKING_SET;
+        if (spec[2] == ':') {
+            char *end;
+            config->tau = strtoul(spec + 3, &end, 10);
+            if (*end != '\0') return false;
+        }
+        return config->tau > 0;
+    }
+    return false;
+}
+
+// pff starts with a single frame and grows from the first faults on; the working set policy may use
+// every frame
+frame_allocation* init_frame_allocation(const allocation_config *config, unsigned int capacity) {
+    frame_allocation *allocation = (frame_allocation*) calloc(1, sizeof(frame_allocation));
+    if (!allocation) return NULL;
+    allocation->config = *config;
+    allocation->capacity = capacity;
+    allocation->history_interval = 1;
+    if (config->policy == ALLOCATION_PFF) {
+        allocation->limit = capacity > 0 ? 1 : 0;
+    } else {
+        allocation->limit = capacity;
+        allocation->last_reference = (unsigned long*) calloc(capacity, sizeof(unsigned long));
+        if (!allocation->last_reference) {
+            free(allocation);
+            return NULL;
+        }
+    }
+    return allocation;
+}
+
+// a fault happened at access `now`: its distance to the previous fault goes into the smoothed gap, whose
+// inverse is the fault rate. Returns 1 if a frame was granted, -1 if one was reclaimed (the caller
+// must give one back if every frame of the limit is in use) and 0 otherwise
+int pff_fault(frame_allocation *allocation, unsigned long now) {
+    double gap = now - allocation->last_fault;
+    allocation->gap = allocation->last_fault == 0 ? gap : allocation->gap + (gap - allocation->gap) / PFF_SMOOTHING;
+    allocation->last_fault = now;
+
+    double rate = 1.0 / allocation->gap;
+    if (rate > allocation->config.upper && allocation->limit < allocation->capacity) {
+        allocation->limit++;
+        allocation->grants++;
+        return 1;
+    }
+    if (rate < allocation->config.lower && allocation->limit > 1) {
+        allocation->limit--;
+        allocation->reclaims++;
+        return -1;
+    }
+    return 0;
+}
+
+// the frames in use changed during access `now`: the old count held for every access before it
+void allocation_resized(frame_allocation *allocation, unsigned int resident, unsigned long now) {
+    unsigned long before = now > 0 ? now - 1 : 0;
+    allocation->frame_accesses += (double) allocation->resident * (before - allocation->since);
+    allocation->since = before;
+    allocation->resident = resident;
+    if (resident > allocation->peak_resident) allocation->peak_resident = resident;
+}
+
+// frames in use on average over the first `now` accesses
+double average_frames(const frame_allocation *allocation, unsigned long now) {
+    if (now == 0) return 0.0;
+    return (allocation->frame_accesses + (double) allocation->resident * (now - allocation->since)) / now;
+}
+
+// keeps a sample of the frames in use; when the history is full, every other sample is dropped and
+// the interval doubles
+void allocation_record(frame_allocation *allocation, unsigned long now) {
+    if (allocation->history_length > 0 && now < allocation->history_time[allocation->history_length - 1] + allocation->history_interval) return;
+    if (allocation->history_length == ALLOCATION_HISTORY) {
+        for (size_t i = 0; i < ALLOCATION_HISTORY / 2; i++) {
+            allocation->history_time[i] = allocation->history_time[2 * i + 1];
+            allocation->history_value[i] = allocation->history_value[2 * i + 1];
+        }
+        allocation->history_length = ALLOCATION_HISTORY / 2;
+        allocation->history_interval *= 2;
+    }
+    allocation->history_time[allocation->history_length] = now;
+    allocation->history_value[allocation->history_length] = allocation->resident;
+    allocation->history_length++;
+}
+
+void free_frame_allocation(frame_allocation *allocation) {
+    if (allocation == NULL) return;
+    free(allocation->last_reference);
+    free(allocation);
+}
@@ -0,0 +1,71 @@
+#ifndef ALLOCATION_H
+#define ALLOCATION_H
+
+#include <stdlib.h>
+#include <stdbool.h>
+#include <stdint.h>
+
+#define ALLOCATION_HISTORY 32
+#define PFF_DEFAULT_LOWER 0.001 // faults per access
+#define PFF_DEFAULT_UPPER 0.01
+#define PFF_SMOOTHING 8 // the distance between faults is averaged over about this many faults
+#define WORKING_SET_DEFAULT_TAU 10000 // accesses
+
+typedef enum { ALLOCATION_PFF, ALLOCATION_WORKING_SET } allocationPolicy;
+
+// how frames are granted and taken back during the run
+//   pff[:<lower>,<upper>]  page fault frequency: at each fault, a fault rate above upper grants one
+//                          more frame and one below lower reclaims one
+//   ws[:<tau>]             working set: pages not referenced in the last tau accesses give their frames back
+typedef struct {
+    allocationPolicy policy;
+    double lower;
+    double upper;
+    unsigned long tau;
+} allocation_config;
+
+// dynamic frame allocation of one simulation. The memory size is only the physical limit: pff grants
+// frames one at a time up to it (limit) and the working set policy uses whatever its pages need. The
+// average is kept as the sum of frames in use over the accesses, updated only when that number changes
+typedef struct {
+    allocation_config config;
+    unsigned int capacity; // physical frames
+    unsigned int limit; // frames the simulation may use (pff; the capacity with the working set policy)
+    double gap; // pff: smoothed accesses between faults
+    unsigned long last_fault; // pff: access of the previous fault
+    unsigned long *last_reference; // working set: access of the last reference to the page of each frame
+    unsigned long grants; // pff: frames granted
+    unsigned long reclaims; // pff: frames taken back
+    unsigned long releases; // frames given back to the free pool along with their pages
+
+    unsigned int resident; // frames in use
+    unsigned int peak_resident;
+    double frame_accesses; // frames in use summed over the accesses up to `since`
+    unsigned long since;
+
+    // samples of the frames in use over the run (see adaptive_record)
+    unsigned long history_time[ALLOCATION_HISTORY];
+    unsigned int history_value[ALLOCATION_HISTORY];
+    size_t history_length;
+    unsigned long history_interval;
+} frame_allocation;
+
+/* ============ FUNCTIONS ============ */
+
+bool parse_allocation_config(const char *spec, allocation_config *config);
+
+frame_allocation* init_frame_allocation(const allocation_config *config, unsigned int capacity);
+
+int pff_fault(frame_allocation *allocation, unsigned long now);
+
+void allocation_resized(frame_allocation *allocation, unsigned int resident, unsigned long now);
+
+double average_frames(const frame_allocation *allocation, unsigned long now);
+
+void allocation_record(frame_allocation *allocation, unsigned long now);
+
+void free_frame_allocation(frame_allocation *allocation);
+
+/* =================================== */
+
+#endif
@@ -0,0 +1,46 @@
+#include "Arena.h"
+
+// initialize an empty arena of nodes with node_size bytes each
+node_arena* init_node_arena(size_t node_size) {
+    node_arena *arena = (node_arena*) malloc(sizeof(node_arena));
+    arena->node_size = (node_size + 15) & ~(size_t) 15; // keeps every node 16-byte aligned
+    arena->nodes_per_slab = ARENA_SLAB_SIZE / arena->node_size;
+    if (arena->nodes_per_slab == 0) arena->nodes_per_slab = 1;
+    arena->slabs = NULL;
+    arena->slab_count = 0;
+    arena->node_count = 0;
+    return arena;
+}
+
+// hands out an uninitialized node, allocating a new slab when the current one is full
+void* arena_alloc(node_arena *arena) {
+    arena_slab *slab = arena->slabs;
+    if (slab == NULL || slab->used == arena->nodes_per_slab) {
+        slab = (arena_slab*) malloc(sizeof(arena_slab) + arena->nodes_per_slab * arena->node_size);
+        if (slab == NULL) return NULL;
+        slab->next = arena->slabs;
+        slab->used = 0;
+        arena->slabs = slab;
+        arena->slab_count++;
+    }
+    arena->node_count++;
+    return slab->nodes + arena->node_size * slab->used++;
+}
+
+// bytes reserved by the arena slabs
+size_t arena_bytes(node_arena *arena) {
+    if (arena == NULL) return 0;
+    return arena->slab_count * (sizeof(arena_slab) + arena->nodes_per_slab * arena->node_size);
+}
+
+// releases every node of the arena: O(number of slabs)
+void free_node_arena(node_arena *arena) {
+    if (arena == NULL) return;
+    arena_slab *slab = arena->slabs;
+    while (slab != NULL) {
+        arena_slab *next = slab->next;
+        free(slab);
+        slab = next;
+    }
+    free(arena);
+}
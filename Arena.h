@@ -0,0 +1,37 @@
+#ifndef ARENA_H
+#define ARENA_H
+
+#include <stdlib.h>
+#include <stdint.h>
+
+#define ARENA_SLAB_SIZE (64 * 1024)
+
+typedef struct arena_slab {
+    struct arena_slab *next;
+    size_t used; // nodes handed out from this slab
+    _Alignas(16) unsigned char nodes[];
+} arena_slab;
+
+// pool of fixed-size nodes carved out of large slabs: a node costs no malloc of its own and
+// every node is released at once when the arena is freed
+typedef struct {
+    size_t node_size;
+    size_t nodes_per_slab;
+    arena_slab *slabs; // the slab nodes are currently taken from is the first one
+    size_t slab_count;
+    size_t node_count;
+} node_arena;
+
+/* ============ FUNCTIONS ============ */
+
+node_arena* init_node_arena(size_t node_size);
+
+void* arena_alloc(node_arena *arena);
+
+size_t arena_bytes(node_arena *arena);
+
+void free_node_arena(node_arena *arena);
+
+/* =================================== */
+
+#endif
@@ -0,0 +1,197 @@
+#include "Bench.h"
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/resource.h>
+#include <sys/wait.h>
+
+static const char *bench_algorithms[] = { "random", "lru", "lfu", "mfu", "lru:scan", "lfu:scan", "mfu:scan", "clock", "second_chance", "wsclock", "opt", "arc", "2q", "lirs" };
+#define BENCH_ALGORITHMS (sizeof(bench_algorithms) / sizeof(bench_algorithms[0]))
+
+// simulates the whole trace with one configuration and measures it (runs in the child process)
+static bench_result run_combination(const bench_config *config, const char *algorithm, tableType table_type,
+                                    const uint64_t *addresses, const char *operations) {
+    bench_result result;
+    memset(&result, 0, sizeof(result));
+
+    simulator *sim = init_simulator(algorithm, config->page_size, config->mem_size, table_type, NULL);
+    if (!sim) {
+        result.failed = true;
+        return result;
+    }
+
+    // opt's pre-pass is part of its cost, so it is timed with the simulation
+    struct timespec start_time, end_time;
+    clock_gettime(CLOCK_MONOTONIC, &start_time);
+    size_t *next_use = NULL;
+    if (sim->replace == opt_replacement) {
+        next_use = compute_next_use(addresses, NULL, config->accesses, sim->offset, sim->address_size);
+        set_next_use(sim, next_use);
+    }
+    simulate_batch(sim, addresses, operations, config->accesses);
+    clock_gettime(CLOCK_MONOTONIC, &end_time);
+
+    page_table_usage usage;
+    get_page_table_usage(sim->page_table, &usage);
+    result.accesses = sim->total_accesses;
+    result.page_faults = sim->page_faults;
+    result.dirty_pages = sim->dirty_pages;
+    result.seconds = (end_time.tv_sec - start_time.tv_sec) + (end_time.tv_nsec - start_time.tv_nsec) / 1e9;
+    result.page_table_bytes = usage.bytes;
+
+    free(next_use);
+    free_simulator(sim);
+    return result;
+}
+
+// every combination runs in its own child process, so its peak RSS is its own and not the
+// high-water mark of everything that ran before it. The child sends the measurements through a pipe
+static bench_result measure(const bench_config *config, const char *algorithm, tableType table_type,
+                            const uint64_t *addresses, const char *operations) {
+    bench_result result;
+    memset(&result, 0, sizeof(result));
+    result.failed = true;
+
+    int channel[2];
+    if (pipe(channel) != 0) return result;
+    fflush(NULL);
+    pid_t child = fork();
+    if (child < 0) {
+        close(channel[0]);
+        close(channel[1]);
+        return result;
+    }
+    if (child == 0) {
+        close(channel[0]);
+        bench_result measured = run_combination(config, algorithm, table_type, addresses, operations);
+        ssize_t written = write(channel[1], &measured, sizeof(measured));
+        close(channel[1]);
+        _exit(written == sizeof(measured) ? 0 : 1);
+    }
+
+    close(channel[1]);
+    ssize_t received = read(channel[0], &result, sizeof(result));
+    close(channel[0]);
+
+    int status;
+    struct rusage usage;
+    if (wait4(child, &status, 0, &usage) < 0 || received != sizeof(result) || !WIFEXITED(status) || WEXITSTATUS(status) != 0) {
+        result.failed = true;
+        return result;
+    }
+    result.peak_rss = usage.ru_maxrss;
+    return result;
+}
+
+// generates every pattern and runs every algorithm x table type over it, writing the results as JSON
+int run_benchmark(const bench_config *config, FILE *out) {
+    uint64_t *addresses = (uint64_t*) malloc((config->accesses ? config->accesses : 1) * sizeof(uint64_t));
+    char *operations = (char*) malloc((config->accesses ? config->accesses : 1) * sizeof(char));
+    if (!addresses || !operations) {
+        free(addresses);
+        free(operations);
+        return -1;
+    }
+
+    fprintf(out, "{\n");
+    fprintf(out, "  \"accesses_per_trace\": %zu,\n", config->accesses);
+    fprintf(out, "  \"page_size\": %u,\n", config->page_size);
+    fprintf(out, "  \"mem_size\": %u,\n", config->mem_size);
+    fprintf(out, "  \"address_space\": %lu,\n", (unsigned long) config->address_space);
+    fprintf(out, "  \"working_set\": %lu,\n", (unsigned long) config->working_set);
+    fprintf(out, "  \"write_ratio\": %g,\n", config->write_ratio);
+    fprintf(out, "  \"seed\": %lu,\n", (unsigned long) config->seed);
+    fprintf(out, "  \"results\": [\n");
+
+    int failures = 0;
+    bool first = true;
+    for (int p = 0; p < PATTERN_COUNT; p++) {
+        generator_config generator;
+        generator.pattern = p;
+        generator.address_space = config->address_space;
+        generator.working_set = config->working_set;
+        generator.stride = GENERATOR_PAGE + GENERATOR_LINE;
+        generator.write_ratio = config->write_ratio;
+        generator.seed = config->seed + p;
+        generate_trace(&generator, addresses, operations, config->accesses);
+
+        for (size_t a = 0; a < BENCH_ALGORITHMS; a++) {
+            for (int t = DENSE_PAGE_TABLE; t <= HASHED; t++) {
+                bench_result result = measure(config, bench_algorithms[a], t, addresses, operations);
+                if (result.failed) failures++;
+
+                fprintf(out, "%s    {\"trace\": \"%s\", \"algorithm\": \"%s\", \"table_type\": %d, ", first ? "" : ",\n",
+                        trace_pattern_name(p), bench_algorithms[a], t);
+                first = false;
+                if (result.failed) {
+                    fprintf(out, "\"failed\": true}");
+                    continue;
+                }
+                fprintf(out, "\"accesses\": %lu, \"page_faults\": %u, \"dirty_pages\": %u, \"seconds\": %.6f, "
+                             "\"accesses_per_sec\": %.0f, \"ns_per_access\": %.2f, \"peak_rss_kb\": %ld, \"page_table_bytes\": %zu}",
+                        result.accesses, result.page_faults, result.dirty_pages, result.seconds,
+                        result.seconds > 0 ? result.accesses / result.seconds : 0.0,
+                        result.accesses ? result.seconds * 1e9 / result.accesses : 0.0,
+                        result.peak_rss, result.page_table_bytes);
+                fflush(out);
+            }
+        }
+    }
+    fprintf(out, "\n  ]\n}\n");
+
+    free(addresses);
+    free(operations);
+    return failures ? -1 : 0;
+}
+
+// repeats the scan until SCAN_BENCH_SECONDS have passed; returns the nanoseconds per scan
+static double time_scan(scan_function scan, const uint32_t *values, size_t frames, size_t *result) {
+    struct timespec start_time, end_time;
+    unsigned long scans = 0;
+    double elapsed;
+    clock_gettime(CLOCK_MONOTONIC, &start_time);
+    do {
+        *result = scan(values, frames);
+        scans++;
+        clock_gettime(CLOCK_MONOTONIC, &end_time);
+        elapsed = (end_time.tv_sec - start_time.tv_sec) + (end_time.tv_nsec - start_time.tv_nsec) / 1e9;
+    } while (elapsed < SCAN_BENCH_SECONDS || scans < 3);
+    return elapsed * 1e9 / scans;
+}
+
+// measures the argmin and argmax scans of every kernel the CPU supports over 1K to max_frames frames
+// (random last uses), writing one CSV row per frame count x kernel. Every kernel must pick the same
+// frame as the scalar one; returns -1 if one does not
+int run_scan_benchmark(size_t max_frames, FILE *out) {
+    const frame_scan_kernel *kernels;
+    size_t kernel_count = get_frame_scan_kernels(&kernels);
+    uint32_t *values = (uint32_t*) malloc(max_frames * sizeof(uint32_t));
+    if (!values) return -1;
+    uint64_t state = 88172645463325252ULL;
+    for (size_t i = 0; i < max_frames; i++) {
+        state ^= state << 13;
+        state ^= state >> 7;
+        state ^= state << 17;
+        values[i] = (uint32_t) state;
+    }
+
+    int failures = 0;
+    fprintf(out, "# kernel picked for this CPU: %s\n", get_frame_scan_kernel()->name);
+    fprintf(out, "frames,kernel,argmin_ns,argmax_ns,frames_per_ns\n");
+    for (size_t frames = SCAN_BENCH_MIN_FRAMES; frames <= max_frames; frames *= 4) {
+        size_t expected_min = kernels[0].argmin(values, frames);
+        size_t expected_max = kernels[0].argmax(values, frames);
+        for (size_t k = 0; k < kernel_count; k++) {
+            size_t min_frame, max_frame;
+            double argmin_ns = time_scan(kernels[k].argmin, values, frames, &min_frame);
+            double argmax_ns = time_scan(kernels[k].argmax, values, frames, &max_frame);
+            if (min_frame != expected_min || max_frame != expected_max) {
+                fprintf(out, "# %s picked frames %zu/%zu instead of %zu/%zu\n", kernels[k].name, min_frame, max_frame, expected_min, expected_max);
+                failures++;
+            }
+            fprintf(out, "%zu,%s,%.1f,%.1f,%.2f\n", frames, kernels[k].name, argmin_ns, argmax_ns, frames / argmin_ns);
+        }
+    }
+    free(values);
+    return failures ? -1 : 0;
+}
@@ -0,0 +1,44 @@
+#ifndef BENCH_H
+#define BENCH_H
+
+#include <stdio.h>
+#include <stdbool.h>
+#include "Simulator.h"
+#include "Generator.h"
+#include "FrameScan.h"
+
+#define SCAN_BENCH_MIN_FRAMES 1024
+#define SCAN_BENCH_MAX_FRAMES (1024 * 1024)
+#define SCAN_BENCH_SECONDS 0.05 // time spent on each frame count x kernel x scan
+
+// what one benchmark run covers: every pattern, algorithm and table type over the same memory
+typedef struct {
+    size_t accesses; // per trace
+    unsigned int page_size; // KB
+    unsigned int mem_size; // KB
+    uint64_t address_space; // bytes
+    uint64_t working_set; // bytes
+    double write_ratio;
+    uint64_t seed;
+} bench_config;
+
+// measurements of one pattern x algorithm x table type combination
+typedef struct {
+    unsigned long accesses;
+    unsigned int page_faults;
+    unsigned int dirty_pages;
+    double seconds;
+    size_t page_table_bytes;
+    long peak_rss; // KB, of the process that ran the combination
+    bool failed;
+} bench_result;
+
+/* ============ FUNCTIONS ============ */
+
+int run_benchmark(const bench_config *config, FILE *out);
+
+int run_scan_benchmark(size_t max_frames, FILE *out);
+
+/* =================================== */
+
+#endif
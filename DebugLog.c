@@ -0,0 +1,193 @@
+#include "DebugLog.h"
+#include <string.h>
+#include <inttypes.h>
+#include <sched.h>
+#include <time.h>
+
+#define WRITER_IDLE_NS 200000 // how long the writer sleeps when the ring is empty
+
+// Função para escrever uma mensagem no log de debug (texto)
+static void write_debug_message(FILE* debug_file, const char* message) {
+    fprintf(debug_file, "%s\n", "=============================");
+    fprintf(debug_file, "%s\n", message);
+    fprintf(debug_file, "%s\n", "=============================");
+}
+
+// writer thread: copies the records published by the simulation to the file, in contiguous runs
+static void* debug_writer(void *arg) {
+    debug_log *log = (debug_log*) arg;
+    while (true) {
+        unsigned long tail = log->tail;
+        unsigned long head = __atomic_load_n(&log->head, __ATOMIC_ACQUIRE);
+        if (head == tail) {
+            if (__atomic_load_n(&log->closing, __ATOMIC_ACQUIRE)) {
+                // the last records may have been published right before closing
+                if (__atomic_load_n(&log->head, __ATOMIC_ACQUIRE) == tail) break;
+                continue;
+            }
+            struct timespec idle = { 0, WRITER_IDLE_NS };
+            nanosleep(&idle, NULL);
+            continue;
+        }
+
+        size_t start = tail & (DEBUG_RING_SIZE - 1);
+        size_t run = head - tail;
+        if (run > DEBUG_RING_SIZE - start) run = DEBUG_RING_SIZE - start; // up to the end of the ring
+        fwrite(&log->ring[start], sizeof(debug_record), run, log->file);
+        log->header.records += run;
+        __atomic_store_n(&log->tail, tail + run, __ATOMIC_RELEASE);
+    }
+    return NULL;
+}
+
+// creates the binary log and starts its writer thread (NULL if the file can't be created)
+debug_log* open_debug_log(const char *path, debugPolicy policy) {
+    debug_log *log = (debug_log*) calloc(1, sizeof(debug_log));
+    log->file = fopen(path, "wb");
+    log->ring = (debug_record*) malloc(DEBUG_RING_SIZE * sizeof(debug_record));
+    if (!log->file || !log->ring) {
+        if (log->file) fclose(log->file);
+        free(log->ring);
+        free(log);
+        return NULL;
+    }
+    log->policy = policy;
+    memcpy(log->header.magic, DEBUG_LOG_MAGIC, sizeof(log->header.magic));
+    log->header.version = DEBUG_LOG_VERSION;
+    log->header.record_size = sizeof(debug_record);
+    fwrite(&log->header, sizeof(log->header), 1, log->file); // rewritten on close, with the counts
+
+    if (pthread_create(&log->writer, NULL, debug_writer, log) != 0) {
+        fclose(log->file);
+        free(log->ring);
+        free(log);
+        return NULL;
+    }
+    return log;
+}
+
+// the ring is full: with the block policy, waits for the writer to free a slot; returns false if
+// the record must be dropped instead
+bool wait_for_debug_space(debug_log *log) {
+    if (log->policy == DEBUG_DROP) return false;
+    while (log->head - __atomic_load_n(&log->tail, __ATOMIC_ACQUIRE) == DEBUG_RING_SIZE) {
+        sched_yield();
+    }
+    return true;
+}
+
+// drains the ring, stops the writer and completes the header; returns 0, or -1 if writing failed
+int close_debug_log(debug_log *log) {
+    if (log == NULL) return 0;
+    __atomic_store_n(&log->closing, true, __ATOMIC_RELEASE);
+    pthread_join(log->writer, NULL);
+
+    log->header.dropped = log->dropped;
+    fseek(log->file, 0, SEEK_SET);
+    fwrite(&log->header, sizeof(log->header), 1, log->file);
+    bool failed = ferror(log->file);
+    if (fclose(log->file) != 0) failed = true;
+    free(log->ring);
+    free(log);
+    return failed ? -1 : 0;
+}
+
+// renders one record as the message the text log used to have
+static void render_record(const debug_record *record, FILE *out) {
+    char log_msg[256];
+    const uint32_t *args = record->args;
+    switch (record->type) {
+        case DEBUG_START:
+            write_debug_message(out, "Iniciando simulação de acessos à memória");
+            return;
+        case DEBUG_ACCESS:
+            snprintf(log_msg, sizeof(log_msg), "Processando acesso: endereço=0x%x, operação=%c", args[0], (char) args[1]);
+            break;
+        case DEBUG_INVERTED_LOOKUP:
+            snprintf(log_msg, sizeof(log_msg), "Procurando página %u na tabela invertida", args[0]);
+            break;
+        case DEBUG_INVERTED_FOUND:
+            snprintf(log_msg, sizeof(log_msg), "Página encontrada no frame %d", (int) args[0]);
+            break;
+        case DEBUG_INVERTED_FREE_ENTRY:
+            snprintf(log_msg, sizeof(log_msg), "Página não encontrada. Espaço livre no frame %d", (int) args[0]);
+            break;
+        case DEBUG_INVERTED_HIT:
+            write_debug_message(out, "Hit na tabela invertida - atualizando dados de acesso");
+            return;
+        case DEBUG_INVERTED_FAULT_FREE:
+            snprintf(log_msg, sizeof(log_msg), "Page fault - alocando página %u no frame livre %d", args[0], (int) args[1]);
+            break;
+        case DEBUG_INVERTED_REPLACE:
+            write_debug_message(out, "Page fault - chamando algoritmo de substituição");
+            return;
+        case DEBUG_VICTIM:
+            snprintf(log_msg, sizeof(log_msg), "Algoritmo selecionou frame %u para substituição", args[0]);
+            break;
+        case DEBUG_DIRTY:
+            write_debug_message(out, "Página substituída estava modificada (dirty)");
+            return;
+        case DEBUG_FAULT:
+            snprintf(log_msg, sizeof(log_msg), "Page fault - página %u-%u-%u não está na memória", args[0], args[1], args[2]);
+            break;
+        case DEBUG_MEMORY_FULL:
+            write_debug_message(out, "Memória cheia - chamando algoritmo de substituição");
+            return;
+        case DEBUG_FREE_FRAME:
+            snprintf(log_msg, sizeof(log_msg), "Alocando página no frame livre %d", (int) args[0]);
+            break;
+        case DEBUG_HIT:
+            snprintf(log_msg, sizeof(log_msg), "Hit - página %u-%u-%u encontrada no frame %d", args[0], args[1], args[2], (int) args[3]);
+            break;
+        case DEBUG_END:
+            snprintf(log_msg, sizeof(log_msg), "Simulação concluída. Acessos: %d, Page Faults: %d, Dirty Pages: %d",
+                     (int) args[0], (int) args[1], (int) args[2]);
+            break;
+        case DEBUG_ACCESS64:
+            snprintf(log_msg, sizeof(log_msg), "Processando acesso: endereço=0x%" PRIx64 ", operação=%c",
+                     ((uint64_t) args[1] << 32) | args[0], (char) args[2]);
+            break;
+        case DEBUG_FAULT64:
+            snprintf(log_msg, sizeof(log_msg), "Page fault - página 0x%" PRIx64 " não está na memória", ((uint64_t) args[1] << 32) | args[0]);
+            break;
+        case DEBUG_HIT64:
+            snprintf(log_msg, sizeof(log_msg), "Hit - página 0x%" PRIx64 " encontrada no frame %d", ((uint64_t) args[1] << 32) | args[0], (int) args[2]);
+            break;
+        case DEBUG_SWITCH:
+            snprintf(log_msg, sizeof(log_msg), "Troca de contexto - processo %u (espaço de endereçamento %u)", args[0], args[1]);
+            break;
+        case DEBUG_RELEASE:
+            snprintf(log_msg, sizeof(log_msg), "Quadro %u liberado pela alocação dinâmica", args[0]);
+            break;
+        default:
+            snprintf(log_msg, sizeof(log_msg), "Evento desconhecido: %u", record->type);
+            break;
+    }
+    write_debug_message(out, log_msg);
+}
+
+// translates a binary debug log back into the text log; returns the number of records or -1
+long decode_debug_log(const char *binary_path, FILE *out, unsigned long *dropped) {
+    FILE *in = fopen(binary_path, "rb");
+    if (!in) return -1;
+
+    debug_log_header header;
+    if (fread(&header, sizeof(header), 1, in) != 1 || memcmp(header.magic, DEBUG_LOG_MAGIC, sizeof(header.magic)) != 0 ||
+        header.version != DEBUG_LOG_VERSION || header.record_size != sizeof(debug_record)) {
+        fclose(in);
+        return -1;
+    }
+
+    debug_record records[1024];
+    long count = 0;
+    size_t n;
+    while ((n = fread(records, sizeof(debug_record), 1024, in)) > 0) {
+        for (size_t i = 0; i < n; i++) {
+            render_record(&records[i], out);
+        }
+        count += n;
+    }
+    fclose(in);
+    if (dropped) *dropped = header.dropped;
+    return count;
+}
@@ -0,0 +1,99 @@
+#ifndef DEBUGLOG_H
+#define DEBUGLOG_H
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <pthread.h>
+
+#define DEBUG_LOG_MAGIC "SMVDEBUG"
+#define DEBUG_LOG_VERSION 1
+#define DEBUG_RING_SIZE (1 << 16) // records; must be a power of two
+
+// one kind of debug event per message of the text log
+typedef enum {
+    DEBUG_START,
+    DEBUG_ACCESS, // address, operation
+    DEBUG_INVERTED_LOOKUP, // page
+    DEBUG_INVERTED_FOUND, // frame
+    DEBUG_INVERTED_FREE_ENTRY, // frame
+    DEBUG_INVERTED_HIT,
+    DEBUG_INVERTED_FAULT_FREE, // page, frame
+    DEBUG_INVERTED_REPLACE,
+    DEBUG_VICTIM, // frame
+    DEBUG_DIRTY,
+    DEBUG_FAULT, // outer, second and third page table indices
+    DEBUG_MEMORY_FULL,
+    DEBUG_FREE_FRAME, // frame
+    DEBUG_HIT, // outer, second and third page table indices, frame
+    DEBUG_END, // memory accesses, page faults, dirty pages
+    DEBUG_ACCESS64, // address (low and high halves), operation
+    DEBUG_FAULT64, // page (low and high halves)
+    DEBUG_HIT64, // page (low and high halves), frame
+    DEBUG_SWITCH, // pid, address space
+    DEBUG_RELEASE, // frame
+    DEBUG_EVENTS
+} debugEvent;
+
+// fixed-size binary record; the text is only built by the decoder
+typedef struct {
+    uint32_t type;
+    uint32_t args[4];
+} debug_record;
+
+// binary log layout: this header, then the records in order
+typedef struct {
+    char magic[8];
+    uint32_t version;
+    uint32_t record_size;
+    uint64_t records;
+    uint64_t dropped; // records lost because the ring was full (drop policy)
+} debug_log_header;
+
+typedef enum { DEBUG_BLOCK, DEBUG_DROP } debugPolicy;
+
+// single-producer single-consumer ring: the simulation appends records without locks and a writer
+// thread drains them to the file. When the ring is full the simulation either waits for the writer
+// (DEBUG_BLOCK) or drops the record and counts it (DEBUG_DROP)
+typedef struct {
+    debug_record *ring;
+    unsigned long head; // next record written by the simulation
+    unsigned long tail; // next record written to the file
+    debugPolicy policy;
+    unsigned long dropped;
+    bool closing;
+    FILE *file;
+    debug_log_header header;
+    pthread_t writer;
+} debug_log;
+
+/* ============ FUNCTIONS ============ */
+
+debug_log* open_debug_log(const char *path, debugPolicy policy);
+
+bool wait_for_debug_space(debug_log *log);
+
+int close_debug_log(debug_log *log);
+
+long decode_debug_log(const char *binary_path, FILE *out, unsigned long *dropped);
+
+/* =================================== */
+
+// appends one event to the ring (called by the simulation thread only)
+static inline void debug_event(debug_log *log, debugEvent type, uint32_t a, uint32_t b, uint32_t c, uint32_t d) {
+    unsigned long head = log->head;
+    if (head - __atomic_load_n(&log->tail, __ATOMIC_ACQUIRE) == DEBUG_RING_SIZE && !wait_for_debug_space(log)) {
+        log->dropped++;
+        return;
+    }
+    debug_record *record = &log->ring[head & (DEBUG_RING_SIZE - 1)];
+    record->type = type;
+    record->args[0] = a;
+    record->args[1] = b;
+    record->args[2] = c;
+    record->args[3] = d;
+    __atomic_store_n(&log->head, head + 1, __ATOMIC_RELEASE);
+}
+
+#endif
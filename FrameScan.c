@@ -0,0 +1,169 @@
+#include "FrameScan.h"
+#include <pthread.h>
+#include <immintrin.h>
+
+// the vector kernels make two passes: the first one finds the extreme value with packed unsigned
+// min/max, the second one finds its first position with packed compares. Both are plain streams
+// over the array, and the second one usually stops before the end
+
+/* ============ SCALAR ============ */
+
+static size_t argmin_scalar(const uint32_t *values, size_t count) {
+    size_t best = 0;
+    for (size_t i = 1; i < count; i++) {
+        if (values[i] < values[best]) best = i;
+    }
+    return best;
+}
+
+static size_t argmax_scalar(const uint32_t *values, size_t count) {
+    size_t best = 0;
+    for (size_t i = 1; i < count; i++) {
+        if (values[i] > values[best]) best = i;
+    }
+    return best;
+}
+
+/* ============ SSE4.1 ============ */
+
+__attribute__((target("sse4.1")))
+static size_t first_equal_sse(const uint32_t *values, size_t count, uint32_t key) {
+    __m128i key4 = _mm_set1_epi32((int) key);
+    size_t i = 0;
+    for (; i + 4 <= count; i += 4) {
+        __m128i found = _mm_cmpeq_epi32(_mm_loadu_si128((const __m128i*) (values + i)), key4);
+        unsigned int mask = _mm_movemask_ps(_mm_castsi128_ps(found));
+        if (mask) return i + __builtin_ctz(mask);
+    }
+    for (; values[i] != key; i++);
+    return i;
+}
+
+__attribute__((target("sse4.1")))
+static uint32_t reduce_sse(__m128i v, int max) {
+    __m128i swapped = _mm_shuffle_epi32(v, _MM_SHUFFLE(1, 0, 3, 2));
+    v = max ? _mm_max_epu32(v, swapped) : _mm_min_epu32(v, swapped);
+    swapped = _mm_shuffle_epi32(v, _MM_SHUFFLE(2, 3, 0, 1));
+    v = max ? _mm_max_epu32(v, swapped) : _mm_min_epu32(v, swapped);
+    return (uint32_t) _mm_cvtsi128_si32(v);
+}
+
+__attribute__((target("sse4.1")))
+static size_t argmin_sse(const uint32_t *values, size_t count) {
+    if (count < 8) return argmin_scalar(values, count);
+    __m128i a = _mm_loadu_si128((const __m128i*) values);
+    __m128i b = _mm_loadu_si128((const __m128i*) (values + 4));
+    size_t i = 8;
+    for (; i + 8 <= count; i += 8) {
+        a = _mm_min_epu32(a, _mm_loadu_si128((const __m128i*) (values + i)));
+        b = _mm_min_epu32(b, _mm_loadu_si128((const __m128i*) (values + i + 4)));
+    }
+    uint32_t min = reduce_sse(_mm_min_epu32(a, b), 0);
+    for (; i < count; i++) {
+        if (values[i] < min) min = values[i];
+    }
+    return first_equal_sse(values, count, min);
+}
+
+__attribute__((target("sse4.1")))
+static size_t argmax_sse(const uint32_t *values, size_t count) {
+    if (count < 8) return argmax_scalar(values, count);
+    __m128i a = _mm_loadu_si128((const __m128i*) values);
+    __m128i b = _mm_loadu_si128((const __m128i*) (values + 4));
+    size_t i = 8;
+    for (; i + 8 <= count; i += 8) {
+        a = _mm_max_epu32(a, _mm_loadu_si128((const __m128i*) (values + i)));
+        b = _mm_max_epu32(b, _mm_loadu_si128((const __m128i*) (values + i + 4)));
+    }
+    uint32_t max = reduce_sse(_mm_max_epu32(a, b), 1);
+    for (; i < count; i++) {
+        if (values[i] > max) max = values[i];
+    }
+    return first_equal_sse(values, count, max);
+}
+
+/* ============ AVX2 ============ */
+
+__attribute__((target("avx2")))
+static size_t first_equal_avx2(const uint32_t *values, size_t count, uint32_t key) {
+    __m256i key8 = _mm256_set1_epi32((int) key);
+    size_t i = 0;
+    for (; i + 8 <= count; i += 8) {
+        __m256i found = _mm256_cmpeq_epi32(_mm256_loadu_si256((const __m256i*) (values + i)), key8);
+        unsigned int mask = _mm256_movemask_ps(_mm256_castsi256_ps(found));
+        if (mask) return i + __builtin_ctz(mask);
+    }
+    for (; values[i] != key; i++);
+    return i;
+}
+
+__attribute__((target("avx2")))
+static size_t argmin_avx2(const uint32_t *values, size_t count) {
+    if (count < 16) return argmin_scalar(values, count);
+    __m256i a = _mm256_loadu_si256((const __m256i*) values);
+    __m256i b = _mm256_loadu_si256((const __m256i*) (values + 8));
+    size_t i = 16;
+    for (; i + 16 <= count; i += 16) {
+        a = _mm256_min_epu32(a, _mm256_loadu_si256((const __m256i*) (values + i)));
+        b = _mm256_min_epu32(b, _mm256_loadu_si256((const __m256i*) (values + i + 8)));
+    }
+    a = _mm256_min_epu32(a, b);
+    uint32_t min = reduce_sse(_mm_min_epu32(_mm256_castsi256_si128(a), _mm256_extracti128_si256(a, 1)), 0);
+    for (; i < count; i++) {
+        if (values[i] < min) min = values[i];
+    }
+    return first_equal_avx2(values, count, min);
+}
+
+__attribute__((target("avx2")))
+static size_t argmax_avx2(const uint32_t *values, size_t count) {
+    if (count < 16) return argmax_scalar(values, count);
+    __m256i a = _mm256_loadu_si256((const __m256i*) values);
+    __m256i b = _mm256_loadu_si256((const __m256i*) (values + 8));
+    size_t i = 16;
+    for (; i + 16 <= count; i += 16) {
+        a = _mm256_max_epu32(a, _mm256_loadu_si256((const __m256i*) (values + i)));
+        b = _mm256_max_epu32(b, _mm256_loadu_si256((const __m256i*) (values + i + 8)));
+    }
+    a = _mm256_max_epu32(a, b);
+    uint32_t max = reduce_sse(_mm_max_epu32(_mm256_castsi256_si128(a), _mm256_extracti128_si256(a, 1)), 1);
+    for (; i < count; i++) {
+        if (values[i] > max) max = values[i];
+    }
+    return first_equal_avx2(values, count, max);
+}
+
+/* ================================ */
+
+// every implementation, slowest first; only the ones the CPU supports are used
+static const frame_scan_kernel scan_kernels[] = {
+    { "scalar", argmin_scalar, argmax_scalar },
+    { "sse4.1", argmin_sse, argmax_sse },
+    { "avx2", argmin_avx2, argmax_avx2 },
+};
+
+static size_t supported_kernels;
+static pthread_once_t kernels_checked = PTHREAD_ONCE_INIT;
+
+// checks the CPU once: AVX2 implies SSE4.1, so the supported kernels are a prefix of the list
+static void check_cpu(void) {
+    __builtin_cpu_init();
+    supported_kernels = 1;
+    if (__builtin_cpu_supports("sse4.1")) {
+        supported_kernels = 2;
+        if (__builtin_cpu_supports("avx2")) supported_kernels = 3;
+    }
+}
+
+// fastest implementation the CPU supports
+const frame_scan_kernel* get_frame_scan_kernel(void) {
+    pthread_once(&kernels_checked, check_cpu);
+    return &scan_kernels[supported_kernels - 1];
+}
+
+// every implementation the CPU supports, scalar first; returns how many there are
+size_t get_frame_scan_kernels(const frame_scan_kernel **kernels) {
+    pthread_once(&kernels_checked, check_cpu);
+    *kernels = scan_kernels;
+    return supported_kernels;
+}
@@ -0,0 +1,25 @@
+#ifndef FRAMESCAN_H
+#define FRAMESCAN_H
+
+#include <stdlib.h>
+#include <stdint.h>
+
+// position of the smallest (argmin) or largest (argmax) value; ties go to the lowest index
+typedef size_t (*scan_function)(const uint32_t *values, size_t count);
+
+// one implementation of the frame scans
+typedef struct {
+    const char *name;
+    scan_function argmin;
+    scan_function argmax;
+} frame_scan_kernel;
+
+/* ============ FUNCTIONS ============ */
+
+const frame_scan_kernel* get_frame_scan_kernel(void);
+
+size_t get_frame_scan_kernels(const frame_scan_kernel **kernels);
+
+/* =================================== */
+
+#endif
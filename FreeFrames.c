@@ -0,0 +1,76 @@
+#include "FreeFrames.h"
+
+// initialize the pool with every frame free
+free_frame_pool* init_free_frame_pool(size_t size) {
+    free_frame_pool *pool = (free_frame_pool*) malloc(sizeof(free_frame_pool));
+    pool->size = size;
+    pool->free_count = 0;
+
+    // counts how many levels are needed until a single word summarizes the whole pool
+    pool->depth = 1;
+    for (size_t words = (size + 63) / 64; words > 1; words = (words + 63) / 64) {
+        pool->depth++;
+    }
+
+    pool->levels = (uint64_t**) malloc(pool->depth * sizeof(uint64_t*));
+    size_t bits = size;
+    for (int l = 0; l < pool->depth; l++) {
+        size_t words = bits > 64 ? (bits + 63) / 64 : 1;
+        pool->levels[l] = (uint64_t*) calloc(words, sizeof(uint64_t));
+        bits = words;
+    }
+
+    for (size_t i = 0; i < size; i++) {
+        return_free_frame(pool, i);
+    }
+    return pool;
+}
+
+// removes the lowest free frame from the pool and returns it, or -1 if there is none
+int take_free_frame(free_frame_pool *pool) {
+    if (pool->free_count == 0) return -1;
+
+    size_t index = 0;
+    for (int l = pool->depth - 1; l >= 0; l--) {
+        index = index * 64 + __builtin_ctzll(pool->levels[l][index]);
+    }
+
+    // clears the frame bit and, while a word becomes empty, the summary bit above it
+    size_t i = index;
+    for (int l = 0; l < pool->depth; l++) {
+        pool->levels[l][i / 64] &= ~(1ULL << (i % 64));
+        if (pool->levels[l][i / 64] != 0) break;
+        i /= 64;
+    }
+    pool->free_count--;
+    return index;
+}
+
+// gives a frame back to the pool (page evicted, process exit, unmap...)
+void return_free_frame(free_frame_pool *pool, int index) {
+    if (is_free_frame(pool, index)) return;
+
+    size_t i = index;
+    for (int l = 0; l < pool->depth; l++) {
+        bool was_empty = pool->levels[l][i / 64] == 0;
+        pool->levels[l][i / 64] |= 1ULL << (i % 64);
+        if (!was_empty) break;
+        i /= 64;
+    }
+    pool->free_count++;
+}
+
+// true if the frame is currently in the pool
+bool is_free_frame(free_frame_pool *pool, int index) {
+    return (pool->levels[0][index / 64] >> (index % 64)) & 1;
+}
+
+// free allocated memory to the pool
+void free_free_frame_pool(free_frame_pool *pool) {
+    if (pool == NULL) return;
+    for (int l = 0; l < pool->depth; l++) {
+        free(pool->levels[l]);
+    }
+    free(pool->levels);
+    free(pool);
+}
@@ -0,0 +1,32 @@
+#ifndef FREE_FRAMES_H
+#define FREE_FRAMES_H
+
+#include <stdlib.h>
+#include <stdbool.h>
+#include <stdint.h>
+
+// pool of free frames kept as a hierarchical bitmap: each bit of an upper level tells whether the
+// matching word below has any free frame, so the lowest free frame is found with one
+// find-first-set per level (at most 4 levels for 16M frames) instead of scanning the memory
+typedef struct {
+    uint64_t **levels; // levels[0] has one bit per frame, the last level is a single word
+    int depth;
+    size_t size;
+    size_t free_count;
+} free_frame_pool;
+
+/* ============ FUNCTIONS ============ */
+
+free_frame_pool* init_free_frame_pool(size_t size);
+
+int take_free_frame(free_frame_pool *pool);
+
+void return_free_frame(free_frame_pool *pool, int index);
+
+bool is_free_frame(free_frame_pool *pool, int index);
+
+void free_free_frame_pool(free_frame_pool *pool);
+
+/* =================================== */
+
+#endif
@@ -0,0 +1,177 @@
+#include "Frequency.h"
+
+// initialize an empty frequency table able to hold frames 0 .. size-1
+frequency_table* init_frequency_table(size_t size) {
+    frequency_table *table = (frequency_table*) malloc(sizeof(frequency_table));
+    table->bucket_of = (frequency_bucket**) malloc(size * sizeof(frequency_bucket*));
+    table->heap_position = (int*) malloc(size * sizeof(int));
+    for (size_t i = 0; i < size; i++) {
+        table->bucket_of[i] = NULL;
+        table->heap_position[i] = -1;
+    }
+    table->lowest = NULL;
+    table->highest = NULL;
+    table->spare = NULL;
+    table->size = size;
+    return table;
+}
+
+/* ============ BUCKET HEAP ============ */
+
+static void heap_swap(frequency_table *table, frequency_bucket *bucket, int a, int b) {
+    int tmp = bucket->frames[a];
+    bucket->frames[a] = bucket->frames[b];
+    bucket->frames[b] = tmp;
+    table->heap_position[bucket->frames[a]] = a;
+    table->heap_position[bucket->frames[b]] = b;
+}
+
+static void heap_sift_up(frequency_table *table, frequency_bucket *bucket, int pos) {
+    while (pos > 0) {
+        int parent = (pos - 1) / 2;
+        if (bucket->frames[parent] < bucket->frames[pos]) break;
+        heap_swap(table, bucket, parent, pos);
+        pos = parent;
+    }
+}
+
+static void heap_sift_down(frequency_table *table, frequency_bucket *bucket, int pos) {
+    while (true) {
+        int smallest = pos;
+        int left = 2 * pos + 1;
+        int right = left + 1;
+        if (left < bucket->count && bucket->frames[left] < bucket->frames[smallest]) smallest = left;
+        if (right < bucket->count && bucket->frames[right] < bucket->frames[smallest]) smallest = right;
+        if (smallest == pos) break;
+        heap_swap(table, bucket, pos, smallest);
+        pos = smallest;
+    }
+}
+
+static void bucket_insert(frequency_table *table, frequency_bucket *bucket, int index) {
+    if (bucket->count == bucket->capacity) {
+        bucket->capacity = bucket->capacity ? bucket->capacity * 2 : 4;
+        bucket->frames = (int*) realloc(bucket->frames, bucket->capacity * sizeof(int));
+    }
+    bucket->frames[bucket->count] = index;
+    table->heap_position[index] = bucket->count;
+    table->bucket_of[index] = bucket;
+    heap_sift_up(table, bucket, bucket->count++);
+}
+
+static void bucket_extract(frequency_table *table, frequency_bucket *bucket, int index) {
+    int pos = table->heap_position[index];
+    int last = --bucket->count;
+    if (pos != last) {
+        heap_swap(table, bucket, pos, last);
+        heap_sift_down(table, bucket, pos);
+        heap_sift_up(table, bucket, pos);
+    }
+    table->heap_position[index] = -1;
+    table->bucket_of[index] = NULL;
+}
+
+/* ============ BUCKET LIST ============ */
+
+// creates (or recycles) an empty bucket and links it between lower and higher
+static frequency_bucket* bucket_create(frequency_table *table, int frequency, frequency_bucket *lower, frequency_bucket *higher) {
+    frequency_bucket *bucket = table->spare;
+    if (bucket != NULL) {
+        table->spare = bucket->higher;
+    } else {
+        bucket = (frequency_bucket*) malloc(sizeof(frequency_bucket));
+        bucket->frames = NULL;
+        bucket->capacity = 0;
+    }
+    bucket->frequency = frequency;
+    bucket->count = 0;
+    bucket->lower = lower;
+    bucket->higher = higher;
+
+    if (lower != NULL) lower->higher = bucket;
+    else table->lowest = bucket;
+    if (higher != NULL) higher->lower = bucket;
+    else table->highest = bucket;
+    return bucket;
+}
+
+// unlinks an empty bucket and keeps it for reuse
+static void bucket_release(frequency_table *table, frequency_bucket *bucket) {
+    if (bucket->lower != NULL) bucket->lower->higher = bucket->higher;
+    else table->lowest = bucket->higher;
+    if (bucket->higher != NULL) bucket->higher->lower = bucket->lower;
+    else table->highest = bucket->lower;
+
+    bucket->lower = NULL;
+    bucket->higher = table->spare;
+    table->spare = bucket;
+}
+
+/* ===================================== */
+
+// stops tracking a frame; does nothing if it is not tracked
+void frequency_remove(frequency_table *table, int index) {
+    frequency_bucket *bucket = table->bucket_of[index];
+    if (bucket == NULL) return;
+
+    bucket_extract(table, bucket, index);
+    if (bucket->count == 0) {
+        bucket_release(table, bucket);
+    }
+}
+
+// sets the frame frequency to 1 (the page has just been brought into the frame)
+void frequency_reset(frequency_table *table, int index) {
+    frequency_remove(table, index);
+
+    frequency_bucket *bucket = table->lowest;
+    if (bucket == NULL || bucket->frequency != 1) {
+        bucket = bucket_create(table, 1, NULL, table->lowest);
+    }
+    bucket_insert(table, bucket, index);
+}
+
+// moves the frame to the bucket right above its current one (the frame was hit)
+void frequency_increment(frequency_table *table, int index) {
+    frequency_bucket *bucket = table->bucket_of[index];
+    if (bucket == NULL) {
+        frequency_reset(table, index);
+        return;
+    }
+
+    frequency_bucket *next = bucket->higher;
+    if (next == NULL || next->frequency != bucket->frequency + 1) {
+        next = bucket_create(table, bucket->frequency + 1, bucket, bucket->higher);
+    }
+    frequency_remove(table, index);
+    bucket_insert(table, next, index);
+}
+
+// returns the lowest index among the frames with the lowest frequency, or -1 if no frame is tracked
+int frequency_least_frequent(frequency_table *table) {
+    return table->lowest != NULL ? table->lowest->frames[0] : -1;
+}
+
+// returns the lowest index among the frames with the highest frequency, or -1 if no frame is tracked
+int frequency_most_frequent(frequency_table *table) {
+    return table->highest != NULL ? table->highest->frames[0] : -1;
+}
+
+static void free_bucket_chain(frequency_bucket *bucket) {
+    while (bucket != NULL) {
+        frequency_bucket *next = bucket->higher;
+        free(bucket->frames);
+        free(bucket);
+        bucket = next;
+    }
+}
+
+// free allocated memory to the frequency table
+void free_frequency_table(frequency_table *table) {
+    if (table == NULL) return;
+    free_bucket_chain(table->lowest);
+    free_bucket_chain(table->spare);
+    free(table->bucket_of);
+    free(table->heap_position);
+    free(table);
+}
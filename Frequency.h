@@ -0,0 +1,47 @@
+#ifndef FREQUENCY_H
+#define FREQUENCY_H
+
+#include <stdlib.h>
+#include <stdbool.h>
+
+// group of frames that share the same access count. Buckets are kept in a doubly linked list
+// ordered by frequency and only exist while they hold at least one frame
+typedef struct frequency_bucket {
+    int frequency;
+    int *frames; // binary min-heap of frame indices: frames[0] is the lowest index in the bucket
+    int count;
+    int capacity;
+    struct frequency_bucket *lower;
+    struct frequency_bucket *higher;
+} frequency_bucket;
+
+// O(1) lfu/mfu bookkeeping: the victim is the lowest index inside the lowest (lfu) or highest (mfu) bucket,
+// which is the same frame the linear scans used to pick
+typedef struct {
+    frequency_bucket **bucket_of; // bucket holding each frame (NULL if the frame is not tracked)
+    int *heap_position; // position of each frame inside its bucket heap
+    frequency_bucket *lowest;
+    frequency_bucket *highest;
+    frequency_bucket *spare; // emptied buckets kept for reuse, so hits don't allocate
+    size_t size;
+} frequency_table;
+
+/* ============ FUNCTIONS ============ */
+
+frequency_table* init_frequency_table(size_t size);
+
+void frequency_reset(frequency_table *table, int index);
+
+void frequency_increment(frequency_table *table, int index);
+
+void frequency_remove(frequency_table *table, int index);
+
+int frequency_least_frequent(frequency_table *table);
+
+int frequency_most_frequent(frequency_table *table);
+
+void free_frequency_table(frequency_table *table);
+
+/* =================================== */
+
+#endif
@@ -0,0 +1,169 @@
+#include "Future.h"
+#include "utils.h"
+#include <string.h>
+
+// (page, process) -> position hash used by the reverse pass (open addressing, linear probing)
+typedef struct {
+    uint64_t *pages;
+    uint32_t *pids;
+    size_t *positions;
+    size_t mask;
+    size_t used;
+} position_map;
+
+static inline size_t hash_page(uint64_t page) {
+    page ^= page >> 33;
+    page *= 0xff51afd7ed558ccdULL;
+    page ^= page >> 33;
+    page *= 0xc4ceb9fe1a85ec53ULL;
+    page ^= page >> 33;
+    return page;
+}
+
+// slot of the page of the process in the map: the one holding it, or the empty one where it would go
+static size_t find_slot(position_map *map, uint64_t page, uint32_t pid) {
+    size_t slot = hash_page(page + pid * 0x9e3779b97f4a7c15ULL) & map->mask;
+    while (map->positions[slot] != NEVER_USED_AGAIN && (map->pages[slot] != page || map->pids[slot] != pid)) {
+        slot = (slot + 1) & map->mask;
+    }
+    return slot;
+}
+
+static void grow_position_map(position_map *map) {
+    position_map bigger;
+    bigger.mask = map->mask * 2 + 1;
+    bigger.used = map->used;
+    bigger.pages = (uint64_t*) malloc((bigger.mask + 1) * sizeof(uint64_t));
+    bigger.pids = (uint32_t*) malloc((bigger.mask + 1) * sizeof(uint32_t));
+    bigger.positions = (size_t*) malloc((bigger.mask + 1) * sizeof(size_t));
+    memset(bigger.positions, 0xff, (bigger.mask + 1) * sizeof(size_t));
+    for (size_t i = 0; i <= map->mask; i++) {
+        if (map->positions[i] == NEVER_USED_AGAIN) continue;
+        size_t slot = find_slot(&bigger, map->pages[i], map->pids[i]);
+        bigger.pages[slot] = map->pages[i];
+        bigger.pids[slot] = map->pids[i];
+        bigger.positions[slot] = map->positions[i];
+    }
+    free(map->pages);
+    free(map->pids);
+    free(map->positions);
+    *map = bigger;
+}
+
+// reverse pass over the trace: next_use[i] is the position of the next reference to the page of
+// access i, or NEVER_USED_AGAIN. The page number depends on the table type only through the offset and
+// the width of the address space (see virtual_page). With `pids` (multi-process traces), pages of
+// different processes are different pages
+size_t* compute_next_use(const uint64_t *addresses, const uint32_t *pids, size_t count, uint32_t offset, uint32_t address_size) {
+    size_t *next_use = (size_t*) malloc((count ? count : 1) * sizeof(size_t));
+    if (!next_use) return NULL;
+
+    position_map map;
+    map.mask = 1023;
+    map.used = 0;
+    map.pages = (uint64_t*) malloc((map.mask + 1) * sizeof(uint64_t));
+    map.pids = (uint32_t*) malloc((map.mask + 1) * sizeof(uint32_t));
+    map.positions = (size_t*) malloc((map.mask + 1) * sizeof(size_t));
+    memset(map.positions, 0xff, (map.mask + 1) * sizeof(size_t));
+
+    for (size_t i = count; i-- > 0;) {
+        uint64_t page = virtual_page(addresses[i], offset, address_size);
+        uint32_t pid = pids ? pids[i] : 0;
+        size_t slot = find_slot(&map, page, pid);
+        if (map.positions[slot] == NEVER_USED_AGAIN) {
+            map.pages[slot] = page;
+            map.pids[slot] = pid;
+            map.used++;
+        }
+        next_use[i] = map.positions[slot];
+        map.positions[slot] = i;
+        if (map.used * 2 > map.mask) grow_position_map(&map);
+    }
+
+    free(map.pages);
+    free(map.pids);
+    free(map.positions);
+    return next_use;
+}
+
+// initialize an empty heap able to hold frames 0 .. size-1
+future_heap* init_future_heap(size_t size) {
+    future_heap *future = (future_heap*) malloc(sizeof(future_heap));
+    future->key = (size_t*) malloc(size * sizeof(size_t));
+    future->heap = (unsigned int*) malloc(size * sizeof(unsigned int));
+    future->position = (int*) malloc(size * sizeof(int));
+    for (size_t i = 0; i < size; i++) {
+        future->position[i] = -1;
+    }
+    future->size = 0;
+    return future;
+}
+
+static inline void place(future_heap *future, size_t index, unsigned int frame) {
+    future->heap[index] = frame;
+    future->position[frame] = index;
+}
+
+static void sift_up(future_heap *future, size_t index) {
+    unsigned int frame = future->heap[index];
+    while (index > 0) {
+        size_t parent = (index - 1) / 2;
+        if (future->key[future->heap[parent]] >= future->key[frame]) break;
+        place(future, index, future->heap[parent]);
+        index = parent;
+    }
+    place(future, index, frame);
+}
+
+static void sift_down(future_heap *future, size_t index) {
+    unsigned int frame = future->heap[index];
+    while (true) {
+        size_t child = 2 * index + 1;
+        if (child >= future->size) break;
+        if (child + 1 < future->size && future->key[future->heap[child + 1]] > future->key[future->heap[child]]) child++;
+        if (future->key[future->heap[child]] <= future->key[frame]) break;
+        place(future, index, future->heap[child]);
+        index = child;
+    }
+    place(future, index, frame);
+}
+
+// sets when the page held by the frame is referenced next, inserting the frame if needed
+void future_set(future_heap *future, unsigned int frame, size_t next_use) {
+    if (future->position[frame] == -1) {
+        future->key[frame] = next_use;
+        place(future, future->size++, frame);
+        sift_up(future, future->size - 1);
+        return;
+    }
+    size_t old = future->key[frame];
+    future->key[frame] = next_use;
+    if (next_use > old) sift_up(future, future->position[frame]);
+    else sift_down(future, future->position[frame]);
+}
+
+// takes a frame out of the heap; does nothing if it is not there
+void future_remove(future_heap *future, unsigned int frame) {
+    int index = future->position[frame];
+    if (index == -1) return;
+    future->position[frame] = -1;
+    if ((size_t) index == --future->size) return;
+
+    unsigned int last = future->heap[future->size];
+    place(future, index, last);
+    sift_up(future, index);
+    sift_down(future, future->position[last]);
+}
+
+// frame whose page is referenced farthest in the future (the root of the heap)
+unsigned int future_farthest(future_heap *future) {
+    return future->heap[0];
+}
+
+void free_future_heap(future_heap *future) {
+    if (future == NULL) return;
+    free(future->key);
+    free(future->heap);
+    free(future->position);
+    free(future);
+}
@@ -0,0 +1,35 @@
+#ifndef FUTURE_H
+#define FUTURE_H
+
+#include <stdlib.h>
+#include <stdbool.h>
+#include <stdint.h>
+
+#define NEVER_USED_AGAIN SIZE_MAX
+
+// indexed max-heap of frames keyed by the trace position of their next reference, used by opt:
+// the root is the frame whose page is needed farthest in the future
+typedef struct {
+    size_t *key; // next use of the page in each frame
+    unsigned int *heap; // frames, ordered by key
+    int *position; // where each frame is in the heap (-1 if it is not there)
+    size_t size;
+} future_heap;
+
+/* ============ FUNCTIONS ============ */
+
+size_t* compute_next_use(const uint64_t *addresses, const uint32_t *pids, size_t count, uint32_t offset, uint32_t address_size);
+
+future_heap* init_future_heap(size_t size);
+
+void future_set(future_heap *future, unsigned int frame, size_t next_use);
+
+void future_remove(future_heap *future, unsigned int frame);
+
+unsigned int future_farthest(future_heap *future);
+
+void free_future_heap(future_heap *future);
+
+/* =================================== */
+
+#endif
@@ -0,0 +1,156 @@
+#include "Generator.h"
+#include <string.h>
+#include <math.h>
+
+static const char *pattern_names[PATTERN_COUNT] = { "sequential", "strided", "loop", "uniform", "zipf", "phases" };
+
+// pattern name -> tracePattern (-1 if unknown)
+int get_trace_pattern(const char *name) {
+    for (int p = 0; p < PATTERN_COUNT; p++) {
+        if (strcmp(name, pattern_names[p]) == 0) return p;
+    }
+    return -1;
+}
+
+const char* trace_pattern_name(tracePattern pattern) {
+    return pattern_names[pattern];
+}
+
+// splitmix64: small, fast and fully determined by the seed
+static inline uint64_t next_random(uint64_t *state) {
+    uint64_t z = (*state += 0x9e3779b97f4a7c15ULL);
+    z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+    return z ^ (z >> 31);
+}
+
+// uniform value in [0, bound)
+static inline uint64_t random_below(uint64_t *state, uint64_t bound) {
+    return bound ? next_random(state) % bound : 0;
+}
+
+static inline double random_unit(uint64_t *state) {
+    return (next_random(state) >> 11) * (1.0 / 9007199254740992.0);
+}
+
+// cumulative distribution of a zipf law over `pages` ranks, sampled by binary search
+static double* zipf_table(size_t pages) {
+    double *cdf = (double*) malloc(pages * sizeof(double));
+    double sum = 0;
+    for (size_t i = 0; i < pages; i++) {
+        sum += 1.0 / pow(i + 1, ZIPF_EXPONENT);
+        cdf[i] = sum;
+    }
+    for (size_t i = 0; i < pages; i++) {
+        cdf[i] /= sum;
+    }
+    return cdf;
+}
+
+static size_t zipf_rank(const double *cdf, size_t pages, double u) {
+    size_t low = 0, high = pages - 1;
+    while (low < high) {
+        size_t middle = (low + high) / 2;
+        if (cdf[middle] < u) low = middle + 1;
+        else high = middle;
+    }
+    return low;
+}
+
+// fills `count` accesses following the pattern:
+//   sequential: one line after the other over the whole address space
+//   strided: jumps of `stride` bytes over the whole address space
+//   loop: sequential over the working set, again and again
+//   uniform: random words of the working set
+//   zipf: pages of the working set by zipf popularity, spread over the address space
+//   phases: eight phases alternating a uniform hot set (at a new place each time) and a sequential scan
+void generate_trace(const generator_config *config, uint64_t *addresses, char *operations, size_t count) {
+    uint64_t state = config->seed;
+    uint64_t space = config->address_space ? config->address_space : 1;
+    uint64_t working_set = config->working_set < space ? config->working_set : space;
+    if (working_set == 0) working_set = 1;
+    uint64_t stride = config->stride ? config->stride : GENERATOR_PAGE;
+
+    size_t pages = working_set / GENERATOR_PAGE ? working_set / GENERATOR_PAGE : 1;
+    uint64_t spacing = space / GENERATOR_PAGE / pages; // pages between two zipf pages
+    if (spacing == 0) spacing = 1;
+    double *cdf = config->pattern == PATTERN_ZIPF ? zipf_table(pages) : NULL;
+
+    size_t phase_length = count / 8 ? count / 8 : 1;
+    uint64_t phase_base = 0;
+
+    for (size_t i = 0; i < count; i++) {
+        uint64_t addr = 0;
+        switch (config->pattern) {
+            case PATTERN_SEQUENTIAL:
+                addr = (i * GENERATOR_LINE) % space;
+                break;
+            case PATTERN_STRIDED:
+                addr = (i * stride) % space;
+                break;
+            case PATTERN_LOOP:
+                addr = (i * GENERATOR_LINE) % working_set;
+                break;
+            case PATTERN_UNIFORM:
+                addr = random_below(&state, working_set) & ~3ULL;
+                break;
+            case PATTERN_ZIPF: {
+                size_t rank = zipf_rank(cdf, pages, random_unit(&state));
+                addr = ((rank * spacing) % (space / GENERATOR_PAGE ? space / GENERATOR_PAGE : 1)) * GENERATOR_PAGE
+                       + (random_below(&state, GENERATOR_PAGE) & ~3ULL);
+                break;
+            }
+            case PATTERN_PHASES:
+            default: {
+                size_t phase = i / phase_length;
+                if (i % phase_length == 0) {
+                    phase_base = random_below(&state, space - working_set + 1) & ~((uint64_t) GENERATOR_PAGE - 1);
+                }
+                if (phase % 2 == 0) {
+                    addr = phase_base + (random_below(&state, working_set) & ~3ULL);
+                } else {
+                    addr = ((i % phase_length) * GENERATOR_LINE) % space;
+                }
+                break;
+            }
+        }
+        addresses[i] = addr % space;
+        operations[i] = random_unit(&state) < config->write_ratio ? 'W' : 'R';
+    }
+    free(cdf);
+}
+
+// fills `count` accesses of `processes` processes (pids 1, 2, ...) running the pattern, each with its
+// own seed and an equal share of the accesses. They take turns of GENERATOR_QUANTUM accesses, as a
+// round-robin scheduler would run them
+void generate_process_trace(const generator_config *config, unsigned int processes, uint64_t *addresses, char *operations,
+                            uint32_t *pids, size_t count) {
+    if (processes < 1) processes = 1;
+    uint64_t *stream_addresses = (uint64_t*) malloc((count ? count : 1) * sizeof(uint64_t));
+    char *stream_operations = (char*) malloc((count ? count : 1) * sizeof(char));
+    size_t *start = (size_t*) malloc((processes + 1) * sizeof(size_t));
+    size_t *taken = (size_t*) calloc(processes, sizeof(size_t));
+
+    // the streams one after the other, then interleaved turn by turn
+    generator_config stream = *config;
+    start[0] = 0;
+    for (unsigned int p = 0; p < processes; p++) {
+        start[p + 1] = start[p] + count / processes + (p < count % processes ? 1 : 0);
+        stream.seed = config->seed + p;
+        generate_trace(&stream, stream_addresses + start[p], stream_operations + start[p], start[p + 1] - start[p]);
+    }
+    for (size_t position = 0; position < count;) {
+        for (unsigned int p = 0; p < processes; p++) {
+            size_t length = start[p + 1] - start[p];
+            for (size_t k = 0; k < GENERATOR_QUANTUM && taken[p] < length; k++, taken[p]++, position++) {
+                addresses[position] = stream_addresses[start[p] + taken[p]];
+                operations[position] = stream_operations[start[p] + taken[p]];
+                pids[position] = p + 1;
+            }
+        }
+    }
+    free(stream_addresses);
+    free(stream_operations);
+    free(start);
+    free(taken);
+}
@@ -0,0 +1,37 @@
+#ifndef GENERATOR_H
+#define GENERATOR_H
+
+#include <stdlib.h>
+#include <stdint.h>
+
+#define GENERATOR_LINE 64 // bytes between consecutive addresses of the sequential patterns
+#define GENERATOR_PAGE 4096 // granularity of the zipf pattern
+#define ZIPF_EXPONENT 0.99
+#define GENERATOR_QUANTUM 10000 // accesses a process runs before the next one takes its turn
+
+typedef enum { PATTERN_SEQUENTIAL, PATTERN_STRIDED, PATTERN_LOOP, PATTERN_UNIFORM, PATTERN_ZIPF, PATTERN_PHASES, PATTERN_COUNT } tracePattern;
+
+// parameters of a synthetic trace. The same configuration always yields the same trace
+typedef struct {
+    tracePattern pattern;
+    uint64_t address_space; // bytes addressed by the trace (at most 2^57, the 5-level address space)
+    uint64_t working_set; // bytes touched by loop, uniform, zipf and each phase of phases
+    uint64_t stride; // strided: bytes between accesses
+    double write_ratio; // fraction of the accesses that are writes
+    uint64_t seed;
+} generator_config;
+
+/* ============ FUNCTIONS ============ */
+
+int get_trace_pattern(const char *name);
+
+const char* trace_pattern_name(tracePattern pattern);
+
+void generate_trace(const generator_config *config, uint64_t *addresses, char *operations, size_t count);
+
+void generate_process_trace(const generator_config *config, unsigned int processes, uint64_t *addresses, char *operations,
+                            uint32_t *pids, size_t count);
+
+/* =================================== */
+
+#endif
@@ -1,85 +1,275 @@
+#define _GNU_SOURCE // qsort_r
 #include "Memory.h"
 
-// initialize memory and each frame attributes
-physical_frame* init_memory(unsigned int total_physical_frames) {
-    physical_frame *memory = (physical_frame*) malloc(total_physical_frames * sizeof(physical_frame));
-    for (size_t i = 0; i < total_physical_frames; i++) {
-        memory[i].virtual_page = NULL;
-        memory[i].modified = false;
-        memory[i].allocated = false;
-        memory[i].last_access_moment = 0;
-        memory[i].access_counter = 0;
+// initialize the frame table; every frame starts free, in the free-frame pool
+frame_table* init_memory(unsigned int total_physical_frames, free_frame_pool **free_frames) {
+    frame_table *memory = (frame_table*) malloc(sizeof(frame_table));
+    memory->frames = total_physical_frames;
+    memory->last_use = NULL;
+    memory->uses = NULL;
+    memory->clock = 0;
+    memory->scan = NULL;
+    memory->entry = (page_table_block**) calloc(total_physical_frames, sizeof(page_table_block*));
+    if (!memory->entry) {
+        free(memory);
+        return NULL;
     }
+    *free_frames = init_free_frame_pool(total_physical_frames);
     return memory;
 }
 
-// searches for a frame not yet allocated
-int find_free_frame(physical_frame *memory, size_t size){
-    for (size_t i = 0; i < size; i++) {
-        if(memory[i].allocated == false){
-            return i;
-        }
+// keeps the last use and use count of every frame, for the scan policies; returns false if the arrays
+// can't be allocated
+bool enable_frame_scan(frame_table *memory) {
+    memory->last_use = (uint32_t*) calloc(memory->frames, sizeof(uint32_t));
+    memory->uses = (uint32_t*) calloc(memory->frames, sizeof(uint32_t));
+    memory->clock = 0;
+    memory->scan = get_frame_scan_kernel();
+    return memory->last_use && memory->uses;
+}
+
+// orders frames by their last use
+static int compare_last_use(const void *a, const void *b, void *last_use) {
+    uint32_t x = ((const uint32_t*) last_use)[*(const uint32_t*) a];
+    uint32_t y = ((const uint32_t*) last_use)[*(const uint32_t*) b];
+    return (x > y) - (x < y);
+}
+
+// the 32 bit clock is about to wrap: the last uses are replaced by their ranks (1 for the least recent
+// frame), which keeps their order and leaves the clock at the number of frames. Happens once every
+// 2^32 accesses at most
+void renumber_frame_clock(frame_table *memory) {
+    uint32_t *order = (uint32_t*) malloc(memory->frames * sizeof(uint32_t));
+    for (size_t i = 0; i < memory->frames; i++) order[i] = i;
+    qsort_r(order, memory->frames, sizeof(uint32_t), compare_last_use, memory->last_use);
+    for (size_t i = 0; i < memory->frames; i++) memory->last_use[order[i]] = i + 1;
+    memory->clock = memory->frames;
+    free(order);
+}
+
+// free allocated memory to the frame table
+void free_memory(frame_table *memory) {
+    if (memory == NULL) return;
+    free(memory->last_use);
+    free(memory->uses);
+    free(memory->entry);
+    free(memory);
+}
+
+// takes the lowest frame not yet allocated out of the pool (-1 if memory is full)
+int find_free_frame(free_frame_pool *free_frames){
+    return take_free_frame(free_frames);
+}
+
+// evicts the page held by the frame and gives the frame back to the free-frame pool
+void release_frame(frame_table *memory, free_frame_pool *free_frames, recency_list *recency, frequency_table *frequency, int index){
+    if (memory->entry[index] != NULL) {
+        *memory->entry[index] = 0; // the page is no longer in memory
     }
-    return -1;
+    memory->entry[index] = NULL;
+    recency_remove(recency, index);
+    frequency_remove(frequency, index);
+    return_free_frame(free_frames, index);
+}
+
+// frames given back by dynamic allocation (no entry) are drawn again
+static unsigned int random_victim(replacement_context *context){
+    unsigned int frame;
+    do {
+        frame = random_replacement(context->rng, context->mem_size);
+    } while (context->memory->entry[frame] == NULL);
+    return frame;
 }
 
-// intermediary function that calls the specific replacement algorithms
-unsigned int frame_to_be_replaced(const char *algorithm, physical_frame *memory, size_t mem_size){
+static unsigned int lru_victim(replacement_context *context){
+    return lru_replacement(context->recency);
+}
+
+static unsigned int mfu_victim(replacement_context *context){
+    return mfu_replacement(context->frequency);
+}
+
+static unsigned int lfu_victim(replacement_context *context){
+    return lfu_replacement(context->frequency);
+}
+
+// scan policies: the same victims as lru, lfu and mfu, picked by scanning the frame table
+static unsigned int lru_scan_victim(replacement_context *context){
+    return context->memory->scan->argmin(context->memory->last_use, context->mem_size);
+}
+
+static unsigned int lfu_scan_victim(replacement_context *context){
+    return context->memory->scan->argmin(context->memory->uses, context->mem_size);
+}
+
+static unsigned int mfu_scan_victim(replacement_context *context){
+    return context->memory->scan->argmax(context->memory->uses, context->mem_size);
+}
+
+// true for the policies that need the last use and use count of the frames (see enable_frame_scan)
+bool is_scan_replacement(replacement_function replace){
+    return replace == lru_scan_victim || replace == lfu_scan_victim || replace == mfu_scan_victim;
+}
+
+// resolves the algorithm name into its replacement function (NULL if the algorithm is unknown);
+// wsclock also accepts its window, as in "wsclock:500"
+replacement_function get_replacement_function(const char *algorithm){
     if(strcmp(algorithm, "random") == 0) {
-        return random_replacement(mem_size);
+        return random_victim;
     } else if(strcmp(algorithm, "lru") == 0) {
-        return lru_replacement(memory, mem_size);
+        return lru_victim;
     } else if(strcmp(algorithm, "mfu") == 0) {
-        return mfu_replacement(memory, mem_size);
+        return mfu_victim;
     } else if(strcmp(algorithm, "lfu") == 0) {
-        return lfu_replacement(memory, mem_size);
+        return lfu_victim;
+    } else if(strcmp(algorithm, "lru:scan") == 0) {
+        return lru_scan_victim;
+    } else if(strcmp(algorithm, "lfu:scan") == 0) {
+        return lfu_scan_victim;
+    } else if(strcmp(algorithm, "mfu:scan") == 0) {
+        return mfu_scan_victim;
+    } else if(strcmp(algorithm, "clock") == 0) {
+        return clock_replacement;
+    } else if(strcmp(algorithm, "second_chance") == 0) {
+        return second_chance_replacement;
+    } else if(strcmp(algorithm, "wsclock") == 0 || strncmp(algorithm, "wsclock:", 8) == 0) {
+        return wsclock_replacement;
+    } else if(strcmp(algorithm, "opt") == 0) {
+        return opt_replacement;
+    } else if(get_adaptive_policy(algorithm) != -1) {
+        return adaptive_replacement;
     }
-    return -1;
+    return NULL;
+}
+
+// working-set window given with the algorithm name ("wsclock:500"), or the default one
+unsigned long get_algorithm_window(const char *algorithm){
+    const char *window = strchr(algorithm, ':');
+    if (window == NULL || atol(window + 1) <= 0) return WSCLOCK_DEFAULT_WINDOW;
+    return atol(window + 1);
 }
 
 // generates a random frame index between zero and memory size (number of pages)
-unsigned int random_replacement(size_t mem_size){
-    return random() % mem_size;
+unsigned int random_replacement(struct random_data *rng, size_t mem_size){
+    int32_t value;
+    random_r(rng, &value);
+    return value % mem_size;
 }
 
-// returns the index of the frame with the lowest last_access_moment value
-unsigned int lru_replacement(physical_frame *memory, size_t mem_size) {
-    int lru_index = -1;
-    int min_access_moment = __INT_MAX__;
+// returns the index of the frame with the lowest last_access_moment value: the recency list
+// is kept in access order, so it is always its head
+unsigned int lru_replacement(recency_list *recency) {
+    return recency_least_recent(recency);
+}
 
-    for (size_t i = 0; i < mem_size; i++) {
-        if (memory[i].last_access_moment < min_access_moment) {
-            min_access_moment = memory[i].last_access_moment;
-            lru_index = i;
-        }
-    }
-    return lru_index;
+// returns the index of the frame with the highest access count (lowest index on ties)
+unsigned int mfu_replacement(frequency_table *frequency) {
+    return frequency_most_frequent(frequency);
 }
 
-// returns the index of the frame with the highest access_counter value
-unsigned int mfu_replacement(physical_frame *memory, size_t mem_size) {
-    int mfu_index = -1;
-    int max_access_counter = -1;
+// returns the index of the frame with the lowest access count (lowest index on ties)
+unsigned int lfu_replacement(frequency_table *frequency) {
+    return frequency_least_frequent(frequency);
+}
 
-    for (size_t i = 0; i < mem_size; i++) {
-        if (memory[i].access_counter > max_access_counter) {
-            max_access_counter = memory[i].access_counter;
-            mfu_index = i;
+/* ============ CLOCK ALGORITHMS ============ */
+
+// initialize the clock hand at frame 0
+clock_state* init_clock_state(size_t mem_size, unsigned long window) {
+    clock_state *clock = (clock_state*) calloc(1, sizeof(clock_state));
+    clock->last_use = (unsigned long*) calloc(mem_size, sizeof(unsigned long));
+    clock->window = window;
+    return clock;
+}
+
+// free allocated memory to the clock hand
+void free_clock_state(clock_state *clock) {
+    if (clock == NULL) return;
+    free(clock->last_use);
+    free(clock->written);
+    free(clock);
+}
+
+// page table entry of the page held by the frame (its reference and modified bits)
+static inline page_table_block* frame_entry(replacement_context *context, unsigned int frame) {
+    return context->memory->entry[frame];
+}
+
+// moves the hand to the next frame in use and returns it; frames given back by dynamic allocation
+// (no entry) are passed over
+static inline unsigned int advance_hand(replacement_context *context) {
+    unsigned int frame;
+    do {
+        frame = context->clock->hand;
+        context->clock->hand = frame + 1 == context->mem_size ? 0 : frame + 1;
+        context->clock->steps++;
+    } while (context->memory->entry[frame] == NULL);
+    return frame;
+}
+
+// clock: the hand clears the reference bit of every referenced page it passes and evicts the first
+// page found with the bit clear. Each clear pays for an earlier reference, so it is O(1) amortized
+unsigned int clock_replacement(replacement_context *context) {
+    while (true) {
+        unsigned int frame = advance_hand(context);
+        page_table_block *entry = frame_entry(context, frame);
+        if (!(*entry & PTE_REFERENCED)) return frame;
+        *entry &= ~PTE_REFERENCED;
+    }
+}
+
+// enhanced second chance: pages are ranked by (referenced, modified) class and the first page of the
+// lowest class after the hand is evicted. A first lap looks for (0, 0) without touching anything; a
+// second lap looks for (0, 1) clearing reference bits on the way, so the next two laps must succeed
+unsigned int second_chance_replacement(replacement_context *context) {
+    while (true) {
+        for (size_t i = 0; i < context->mem_size; i++) {
+            unsigned int frame = advance_hand(context);
+            if (!(*frame_entry(context, frame) & (PTE_REFERENCED | PTE_MODIFIED))) return frame;
+        }
+        for (size_t i = 0; i < context->mem_size; i++) {
+            unsigned int frame = advance_hand(context);
+            page_table_block *entry = frame_entry(context, frame);
+            if (!(*entry & PTE_REFERENCED)) return frame;
+            *entry &= ~PTE_REFERENCED;
         }
     }
-    return mfu_index;
 }
 
-// returns the index of the frame with the lowest access_counter value
-unsigned int lfu_replacement(physical_frame *memory, size_t mem_size) {
-    int lfu_index = -1;
-    int min_access_counter = __INT_MAX__;
+// wsclock: referenced pages get their last use set to now; unreferenced pages older than the window
+// leave the working set and are evicted if clean, or written back (cleaned) if dirty. If a whole lap
+// finds nothing, the first clean page seen is evicted, or the page under the hand as a last resort
+unsigned int wsclock_replacement(replacement_context *context) {
+    clock_state *clock = context->clock;
+    int first_clean = -1;
+
+    // the second lap only finds pages cleaned (or unreferenced) during the first one
+    for (size_t i = 0; i < 2 * context->mem_size; i++) {
+        unsigned int frame = advance_hand(context);
+        page_table_block *entry = frame_entry(context, frame);
 
-    for (size_t i = 0; i < mem_size; i++) {
-        if (memory[i].access_counter < min_access_counter) {
-            min_access_counter = memory[i].access_counter;
-            lfu_index = i;
+        if (*entry & PTE_REFERENCED) {
+            *entry &= ~PTE_REFERENCED;
+            clock->last_use[frame] = context->now;
+        } else if (context->now - clock->last_use[frame] > clock->window) {
+            if (!(*entry & PTE_MODIFIED)) return frame;
+            // schedules the write of the old page: it is written back right away and counted as dirty
+            *entry &= ~PTE_MODIFIED;
+            if (clock->written) clock->written[clock->writebacks] = frame;
+            clock->writebacks++;
         }
+        if (first_clean == -1 && !(*entry & PTE_MODIFIED)) first_clean = frame;
     }
-    return lfu_index;
+    return first_clean != -1 ? (unsigned int) first_clean : advance_hand(context);
+}
+
+// opt (Belady): evicts the page whose next reference is the farthest away, which is the root of the
+// future heap. The keys come from the next-use pre-pass over the trace, so each fault is O(log frames)
+unsigned int opt_replacement(replacement_context *context) {
+    return future_farthest(context->future);
+}
+
+// arc, 2q and lirs: the victim comes from the lists kept by the policy on every hit and load
+unsigned int adaptive_replacement(replacement_context *context) {
+    return adaptive_victim(context->adaptive);
 }
@@ -5,31 +5,114 @@
 #include <stdbool.h>
 #include <string.h>
 #include "PageTable.h"
+#include "Recency.h"
+#include "Frequency.h"
+#include "FreeFrames.h"
+#include "Future.h"
+#include "Adaptive.h"
+#include "FrameScan.h"
 
+// frame table, one array per attribute of the frames. Only the link to the page table entry of the
+// resident page is kept here: its valid, referenced and modified bits live in the entry alone (the
+// inverted table links frame i to its entry i), and the replacement state has its own structures.
+// The scan policies (lru:scan, lfu:scan and mfu:scan) also keep the last use and the use count of every
+// frame, as plain uint32_t arrays the vector scans read 8 frames at a time
 typedef struct {
-    bool modified; // true whenever something is written into the page
-    bool allocated; // true if it is not a free-frame
-    int last_access_moment; // use in lru
-    int access_counter;      // use in MFU
-    page_table_block *virtual_page;
-} physical_frame;
+    size_t frames;
+    page_table_block **entry; // entry of the page held by each frame (NULL while the frame is free)
+    uint32_t *last_use; // scan policies only (NULL otherwise): logical time of the last access to each frame
+    uint32_t *uses; // scan policies only: accesses to the page of each frame since it was loaded
+    uint32_t clock; // logical time of the last access
+    const frame_scan_kernel *scan; // argmin/argmax implementation picked for the CPU
+} frame_table;
+
+#define WSCLOCK_DEFAULT_WINDOW 1000
+
+// state of the clock hand that sweeps the frame table (clock, second_chance and wsclock)
+typedef struct {
+    unsigned int hand; // next frame to be examined
+    unsigned long steps; // frames examined by the hand since the start
+    unsigned long writebacks; // dirty pages wsclock cleaned while sweeping, not yet added to the dirty count
+    unsigned int *written; // frames of those pages, when the caller needs them (NULL otherwise)
+    unsigned long *last_use; // wsclock: virtual time the page of each frame was last seen referenced
+    unsigned long window; // wsclock: working-set window (tau), in accesses
+} clock_state;
+
+// everything a replacement algorithm may look at. Reference and modified bits live in the page table
+// entries, reached through memory->entry[i] for every table type
+typedef struct {
+    size_t mem_size;
+    recency_list *recency;
+    frequency_table *frequency;
+    struct random_data *rng;
+    clock_state *clock;
+    future_heap *future; // opt: frames keyed by the next use of their pages
+    adaptive_cache *adaptive; // arc, 2q and lirs: lists of resident pages and ghosts
+    frame_table *memory;
+    unsigned long now; // accesses simulated so far (virtual time)
+} replacement_context;
+
+// victim selection shared by every algorithm, so the algorithm can be picked once instead of on every fault
+typedef unsigned int (*replacement_function)(replacement_context *context);
 
 /* ============ FUNCTIONS ============ */
 
-physical_frame* init_memory(unsigned int total_physical_frames);
+frame_table* init_memory(unsigned int total_physical_frames, free_frame_pool **free_frames);
+
+bool enable_frame_scan(frame_table *memory);
+
+void renumber_frame_clock(frame_table *memory);
+
+bool is_scan_replacement(replacement_function replace);
+
+int find_free_frame(free_frame_pool *free_frames);
+
+void release_frame(frame_table *memory, free_frame_pool *free_frames, recency_list *recency, frequency_table *frequency, int index);
 
-int find_free_frame(physical_frame *memory, size_t size);
+unsigned int random_replacement(struct random_data *rng, size_t mem_size);
 
-unsigned int random_replacement(size_t mem_size);
+unsigned int lru_replacement(recency_list *recency);
 
-unsigned int lru_replacement(physical_frame *memory, size_t mem_size);
+unsigned int mfu_replacement(frequency_table *frequency);
 
-unsigned int mfu_replacement(physical_frame *memory, size_t mem_size);
+unsigned int lfu_replacement(frequency_table *frequency);
 
-unsigned int lfu_replacement(physical_frame *memory, size_t mem_size);
+unsigned int clock_replacement(replacement_context *context);
 
-unsigned int frame_to_be_replaced(const char *algorithm, physical_frame *memory, size_t mem_size);
+unsigned int second_chance_replacement(replacement_context *context);
+
+unsigned int wsclock_replacement(replacement_context *context);
+
+unsigned int opt_replacement(replacement_context *context);
+
+unsigned int adaptive_replacement(replacement_context *context);
+
+clock_state* init_clock_state(size_t mem_size, unsigned long window);
+
+void free_clock_state(clock_state *clock);
+
+replacement_function get_replacement_function(const char *algorithm);
+
+unsigned long get_algorithm_window(const char *algorithm);
+
+void free_memory(frame_table *memory);
 
 /* =================================== */
 
+// the page of the frame was accessed again (scan policies only)
+static inline void frame_accessed(frame_table *memory, unsigned int frame) {
+    if (memory->last_use == NULL) return;
+    if (memory->clock == UINT32_MAX) renumber_frame_clock(memory);
+    memory->last_use[frame] = ++memory->clock;
+    if (memory->uses[frame] != UINT32_MAX) memory->uses[frame]++;
+}
+
+// a page was just brought into the frame (scan policies only)
+static inline void frame_loaded(frame_table *memory, unsigned int frame) {
+    if (memory->last_use == NULL) return;
+    if (memory->clock == UINT32_MAX) renumber_frame_clock(memory);
+    memory->last_use[frame] = ++memory->clock;
+    memory->uses[frame] = 1;
+}
+
 #endif
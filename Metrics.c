@@ -0,0 +1,124 @@
+#include "Metrics.h"
+#include <string.h>
+
+static inline size_t home_slot(const metrics_stream *stream, uint64_t page) {
+    page ^= page >> 33;
+    page *= 0xff51afd7ed558ccdULL;
+    page ^= page >> 33;
+    return page & stream->hash_mask;
+}
+
+// slot holding the page, or the empty slot where it would go
+static size_t find_slot(const metrics_stream *stream, uint64_t page) {
+    size_t slot = home_slot(stream, page);
+    while (stream->hash[slot] != -1 && stream->ring[stream->hash[slot]] != page) {
+        slot = (slot + 1) & stream->hash_mask;
+    }
+    return slot;
+}
+
+// empties the slot with a backward shift, so probes never meet a hole
+static void delete_slot(metrics_stream *stream, size_t hole) {
+    size_t slot = hole;
+    while (true) {
+        slot = (slot + 1) & stream->hash_mask;
+        if (stream->hash[slot] == -1) break;
+        size_t home = home_slot(stream, stream->ring[stream->hash[slot]]);
+        // the entry may move into the hole only if its home is not between the hole and its slot
+        if (((slot - home) & stream->hash_mask) >= ((slot - hole) & stream->hash_mask)) {
+            stream->hash[hole] = stream->hash[slot];
+            hole = slot;
+        }
+    }
+    stream->hash[hole] = -1;
+}
+
+// opens the stream: a name ending in .bin gets binary records, anything else CSV. A window closes
+// every `interval` accesses and the working set looks at the last `tau` references. Returns NULL if
+// the parameters are out of range or the file or memory can't be allocated
+metrics_stream* open_metrics(const char *path, unsigned long interval, unsigned long tau) {
+    if (interval == 0 || interval > UINT32_MAX || tau == 0 || tau > METRICS_MAX_TAU) return NULL;
+    metrics_stream *stream = (metrics_stream*) calloc(1, sizeof(metrics_stream));
+    if (!stream) return NULL;
+    size_t length = strlen(path);
+    stream->format = length >= 4 && strcmp(path + length - 4, ".bin") == 0 ? METRICS_BINARY : METRICS_CSV;
+    stream->interval = interval;
+    stream->remaining = interval;
+    stream->tau = tau;
+
+    size_t slots = 1;
+    while (slots < 2 * tau) slots <<= 1;
+    stream->ring = (uint64_t*) malloc(tau * sizeof(uint64_t));
+    stream->hash = (int*) malloc(slots * sizeof(int));
+    stream->hash_mask = slots - 1;
+    stream->file = fopen(path, stream->format == METRICS_BINARY ? "wb" : "w");
+    if (!stream->ring || !stream->hash || !stream->file) {
+        if (stream->file) fclose(stream->file);
+        free(stream->ring);
+        free(stream->hash);
+        free(stream);
+        return NULL;
+    }
+    memset(stream->hash, 0xff, slots * sizeof(int));
+
+    if (stream->format == METRICS_BINARY) {
+        metrics_header header;
+        memcpy(header.magic, METRICS_MAGIC, sizeof(header.magic));
+        header.version = METRICS_VERSION;
+        header.record_size = sizeof(metrics_record);
+        header.interval = interval;
+        header.tau = tau;
+        fwrite(&header, sizeof(header), 1, stream->file);
+    } else {
+        fprintf(stream->file, "accesses,window_accesses,page_faults,fault_rate,dirty_pages,resident_pages,working_set\n");
+    }
+    return stream;
+}
+
+// the page was referenced: the reference τ positions back leaves the working set window and this
+// one enters it
+void metrics_reference(metrics_stream *stream, uint64_t page) {
+    size_t position = stream->position;
+    if (stream->full) {
+        // the leaving page drops out only if it was not referenced again since
+        size_t slot = find_slot(stream, stream->ring[position]);
+        if (stream->hash[slot] == (int) position) {
+            delete_slot(stream, slot);
+            stream->working_set--;
+        }
+    }
+
+    // no hash entry points to this position anymore, so the page can take it
+    stream->ring[position] = page;
+    size_t slot = find_slot(stream, page);
+    if (stream->hash[slot] == -1) stream->working_set++;
+    stream->hash[slot] = position;
+
+    if (++position == stream->tau) {
+        position = 0;
+        stream->full = true;
+    }
+    stream->position = position;
+}
+
+// appends one window to the stream
+void write_metrics(metrics_stream *stream, const metrics_record *record) {
+    if (stream->format == METRICS_BINARY) {
+        fwrite(record, sizeof(metrics_record), 1, stream->file);
+    } else {
+        fprintf(stream->file, "%lu,%u,%u,%.6f,%u,%u,%lu\n", (unsigned long) record->accesses, record->window_accesses,
+                record->page_faults, record->window_accesses ? (double) record->page_faults / record->window_accesses : 0.0,
+                record->dirty_pages, record->resident_pages, (unsigned long) record->working_set);
+    }
+}
+
+// closes the stream; returns -1 if the file could not be written
+int close_metrics(metrics_stream *stream) {
+    if (stream == NULL) return 0;
+    bool failed = ferror(stream->file);
+    if (fclose(stream->file) != 0) failed = true;
+    free(stream->ring);
+    free(stream->hash);
+    free(stream);
+    return failed ? -1 : 0;
+}
@@ -0,0 +1,68 @@
+#ifndef METRICS_H
+#define METRICS_H
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <stdint.h>
+
+#define METRICS_MAGIC "SMVMETRC"
+#define METRICS_VERSION 1
+#define METRICS_INTERVAL 100000 // default accesses per window
+#define METRICS_MAX_TAU (1UL << 28) // references remembered by the working set
+
+typedef enum { METRICS_CSV, METRICS_BINARY } metricsFormat;
+
+// one window of the stream: counters of the window and the state at its end
+typedef struct {
+    uint64_t accesses; // accesses simulated up to the end of the window
+    uint32_t window_accesses;
+    uint32_t page_faults; // in the window
+    uint32_t dirty_pages; // dirty pages written back in the window
+    uint32_t resident_pages; // frames in use at the end of the window
+    uint64_t working_set; // W(t, τ): distinct pages among the last τ references
+} metrics_record;
+
+// binary layout: this header, then one metrics_record per window
+typedef struct {
+    char magic[8];
+    uint32_t version;
+    uint32_t record_size;
+    uint64_t interval;
+    uint64_t tau;
+} metrics_header;
+
+// windowed time series of a simulation. The working set is kept incrementally: a ring holds the page
+// of each of the last τ references and an open addressing hash maps every page in the window to the
+// ring position of its latest reference. A reference adds its page if the hash doesn't have it; the
+// reference leaving the window removes its page if it was still the latest one. Both cost O(1)
+typedef struct {
+    FILE *file;
+    metricsFormat format;
+    unsigned long interval;
+    unsigned long remaining; // accesses left in the current window
+    unsigned long faults; // counters of the simulation when the window started
+    unsigned int dirty_pages;
+
+    unsigned long tau;
+    uint64_t *ring; // page of each of the last tau references
+    size_t position; // next ring position
+    bool full; // every ring position holds a reference
+    int *hash; // page -> ring position of its latest reference (-1 if the slot is empty)
+    size_t hash_mask;
+    uint64_t working_set;
+} metrics_stream;
+
+/* ============ FUNCTIONS ============ */
+
+metrics_stream* open_metrics(const char *path, unsigned long interval, unsigned long tau);
+
+void metrics_reference(metrics_stream *stream, uint64_t page);
+
+void write_metrics(metrics_stream *stream, const metrics_record *record);
+
+int close_metrics(metrics_stream *stream);
+
+/* =================================== */
+
+#endif
@@ -1,4 +1,5 @@
 #include "PageTable.h"
+#include "Profile.h"
 
 // initialize page table
 page_table* init_page_table(unsigned int number_of_pages, tableType type){
@@ -18,18 +19,22 @@ page_table* init_page_table(unsigned int number_of_pages, tableType type){
         case INVERTED:
             table->table = init_inverted_page_table(number_of_pages);
             break;
+        case HASHED:
+            table->table = init_hashed_page_table(number_of_pages);
+            break;
+        case FOUR_LEVEL:
+        case FIVE_LEVEL: // sized by the page number, not by the outer table: see init_radix_page_table
+            free(table);
+            return NULL;
     }
     return table;
 }
 
-// initialize dense page table
+// initialize dense page table: every entry starts invalid (zero), so the pages of the table are only
+// touched when a page in them is first accessed
 dense_page_table* init_dense_page_table(unsigned int number_of_pages) {
     dense_page_table *table = (dense_page_table*) malloc(sizeof(dense_page_table));
-    table->data = (page_table_block*) malloc(number_of_pages * sizeof(page_table_block));
-    for (size_t i = 0; i < number_of_pages; i++) {
-        table->data[i].valid = false;
-        table->data[i].frame = -1;
-    }
+    table->data = (page_table_block*) calloc(number_of_pages, sizeof(page_table_block));
     return table;
 }
 
@@ -40,6 +45,7 @@ two_level_page_table* init_two_level_page_table(unsigned int number_of_pages) {
     for (size_t i = 0; i < number_of_pages; i++) {
         table->data[i].inner_table = NULL;
     }
+    table->inner_nodes = NULL;
     return table;
 }
 
@@ -50,22 +56,101 @@ three_level_page_table* init_three_level_page_table(unsigned int number_of_pages
     for (size_t i = 0; i < number_of_pages; i++) {
         table->data[i].inner_table = NULL;
     }
+    table->middle_nodes = NULL;
+    table->inner_nodes = NULL;
     return table;
 }
 
 // initialize the inverted page table
 inverted_page_table* init_inverted_page_table(unsigned int number_of_pages){
     inverted_page_table *table = (inverted_page_table*) malloc(sizeof(inverted_page_table));
-    table->data = (inverted_page_table_block*) malloc(number_of_pages * sizeof(inverted_page_table_block));
+    table->data = (page_table_block*) calloc(number_of_pages, sizeof(page_table_block));
+    table->pages = (int32_t*) malloc(number_of_pages * sizeof(int32_t));
+    table->asids = (uint32_t*) calloc(number_of_pages, sizeof(uint32_t));
+    table->next = (int*) malloc(number_of_pages * sizeof(int));
     for (size_t i = 0; i < number_of_pages; i++) {
-        table->data[i].frame = -1;
-        table->data[i].page = -1;
-        table->data[i].last_access_moment = 0;
-        table->data[i].modified = false;
+        table->pages[i] = -1;
+        table->next[i] = -1;
     }
+
+    // twice as many anchors as entries keeps the chains short
+    uint32_t anchors = 1;
+    while (anchors < 2 * number_of_pages) anchors <<= 1;
+    table->hash_anchor = (int*) malloc(anchors * sizeof(int));
+    for (size_t i = 0; i < anchors; i++) {
+        table->hash_anchor[i] = -1;
+    }
+    table->hash_mask = anchors - 1;
+    table->free_entries = init_free_frame_pool(number_of_pages);
+    table->hash_lookups = 0;
+    table->hash_probes = 0;
+
+    table->recency = init_recency_list(number_of_pages);
+    table->frequency = init_frequency_table(number_of_pages);
     return table;
 }
 
+// initialize a four or five level page table for page numbers of `page_bits` bits: initially only the outer table is allocated
+page_table* init_radix_page_table(tableType type, uint32_t page_bits) {
+    int levels = type == FIVE_LEVEL ? 5 : 4;
+    if (page_bits < (uint32_t) levels) return NULL;
+
+    page_table *table = (page_table*) malloc(sizeof(page_table));
+    radix_page_table *radix = (radix_page_table*) calloc(1, sizeof(radix_page_table));
+    radix->levels = levels;
+    uint32_t shift = 0;
+    for (int l = levels - 1; l > 0; l--) {
+        radix->bits[l] = page_bits / levels;
+        radix->shift[l] = shift;
+        shift += radix->bits[l];
+    }
+    radix->bits[0] = page_bits - shift;
+    radix->shift[0] = shift;
+
+    table->type = type;
+    table->table_size = 1U << radix->bits[0];
+    table->table = radix;
+    radix->root = (void**) calloc(table->table_size, sizeof(void*));
+    return table;
+}
+
+// initialize a hashed page table able to hold the pages of every frame
+hashed_page_table* init_hashed_page_table(unsigned int number_of_frames) {
+    hashed_page_table *table = (hashed_page_table*) malloc(sizeof(hashed_page_table));
+    size_t entries = (size_t) number_of_frames + 1;
+    table->entries = (hashed_page_table_entry*) malloc(entries * sizeof(hashed_page_table_entry));
+    for (size_t i = 0; i < entries; i++) {
+        table->entries[i].next = i + 1 < entries ? (int) i + 1 : -1;
+    }
+    table->free_entries = 0;
+
+    // twice as many buckets as entries keeps the chains short, as in the inverted table
+    uint64_t buckets = 1;
+    while (buckets < 2 * entries) buckets <<= 1;
+    table->buckets = (int*) malloc(buckets * sizeof(int));
+    for (size_t i = 0; i < buckets; i++) {
+        table->buckets[i] = -1;
+    }
+    table->hash_mask = buckets - 1;
+    table->lookups = 0;
+    table->probes = 0;
+    return table;
+}
+
+// bits of the virtual addresses each table type translates
+uint32_t table_address_size(tableType type) {
+    switch (type) {
+        case FOUR_LEVEL:
+            return FOUR_LEVEL_ADDRESS_SIZE;
+        case FIVE_LEVEL:
+            return FIVE_LEVEL_ADDRESS_SIZE;
+        case HASHED:
+            return HASHED_ADDRESS_SIZE;
+        default:
+            return ADDRESS_SIZE;
+    }
+}
+
 // free allocated memory to the page table
 void free_page_table(page_table* table, tableType type){
     if (table == NULL) return;
@@ -81,7 +166,14 @@ void free_page_table(page_table* table, tableType type){
             free_three_level_page_table(table);
             break;
         case INVERTED:
-            free_dense_page_table(table);
+            free_inverted_page_table(table);
+            break;
+        case FOUR_LEVEL:
+        case FIVE_LEVEL:
+            free_radix_page_table(table);
+            break;
+        case HASHED:
+            free_hashed_page_table(table);
             break;
     }
 }
@@ -94,36 +186,27 @@ void free_dense_page_table(page_table* table){
     free(table);
 }
 
-// free allocated memory to two level page table
+// free allocated memory to two level page table: inner tables live in the arena and are released with it
 void free_two_level_page_table(page_table* table){
     if (table == NULL) return;
 
     two_level_page_table* table_ptr = (two_level_page_table*) table->table;
     if (table_ptr != NULL) {
-        // iterate through the outer table and frees the inner tables (dense type) if they were allocated
-        for (size_t i = 0; i < table->table_size; i++) {
-            if (table_ptr->data[i].inner_table != NULL) {
-                free_page_table(table_ptr->data[i].inner_table, DENSE_PAGE_TABLE);
-            }
-        }
+        free_node_arena(table_ptr->inner_nodes);
         free(table_ptr->data);
         free(table_ptr);
     }
     free(table);
 }
 
-// free allocated memory to three level page table
+// free allocated memory to three level page table: second and third level tables live in the arenas
 void free_three_level_page_table(page_table* table){
     if (table == NULL) return;
 
     three_level_page_table* table_ptr = (three_level_page_table*) table->table;
     if (table_ptr != NULL) {
-        // iterate through the outer table and frees the inner tables (two level type) if they were allocated
-        for (size_t i = 0; i < table->table_size; i++) {
-            if (table_ptr->data[i].inner_table != NULL) {
-                free_page_table(table_ptr->data[i].inner_table, TWO_LEVEL);
-            }
-        }
+        free_node_arena(table_ptr->middle_nodes);
+        free_node_arena(table_ptr->inner_nodes);
         free(table_ptr->data);
         free(table_ptr);
     }
@@ -133,125 +216,303 @@ void free_three_level_page_table(page_table* table){
 // free allocated memory to inverted page table
 void free_inverted_page_table(page_table* table){
     inverted_page_table* table_ptr = (inverted_page_table*) table->table;
+    free_recency_list(table_ptr->recency);
+    free_frequency_table(table_ptr->frequency);
+    free(table_ptr->hash_anchor);
+    free_free_frame_pool(table_ptr->free_entries);
     free(table_ptr->data);
+    free(table_ptr->pages);
+    free(table_ptr->asids);
+    free(table_ptr->next);
     free(table_ptr);
     free(table);
 }
 
-// this function is reponsible for returning the block itself associated with the address
-page_table_block* get_page(page_table* table, int32_t outer_page_addr, int32_t second_inner_page_addr, int32_t third_inner_page_addr,
-                           uint32_t second_inner_table_offset, uint32_t third_inner_table_offset){
+// free allocated memory to a four or five level page table: lower level tables live in the arenas
+void free_radix_page_table(page_table* table){
+    radix_page_table* table_ptr = (radix_page_table*) table->table;
+    for (int l = 1; l < table_ptr->levels; l++) {
+        free_node_arena(table_ptr->nodes[l]);
+    }
+    free(table_ptr->root);
+    free(table_ptr);
+    free(table);
+}
 
-    switch (table->type) {
-        // in dense tables, only the outer table address is considered, since there is only one table
-        case DENSE_PAGE_TABLE: {
-            dense_page_table* outer_table = (dense_page_table*) table->table;
-            return &outer_table->data[outer_page_addr];
-        }
-        // in two level tables, the outer table and the second inner table addresses are considered, since there are two tables
-        case TWO_LEVEL: {
-            dense_page_table* dense_table_ptr;
-            two_level_page_table* outer_table = (two_level_page_table*) table->table;
+// free allocated memory to hashed page table
+void free_hashed_page_table(page_table* table){
+    hashed_page_table* table_ptr = (hashed_page_table*) table->table;
+    free(table_ptr->entries);
+    free(table_ptr->buckets);
+    free(table_ptr);
+    free(table);
+}
 
-            // checks if the inner table is allocated already; if not, initialize it
-            if(outer_table->data[outer_page_addr].inner_table == NULL){
-                outer_table->data[outer_page_addr].inner_table = init_page_table(pow(2, second_inner_table_offset), DENSE_PAGE_TABLE);
-            }
-            dense_table_ptr = (dense_page_table*) outer_table->data[outer_page_addr].inner_table->table;
-            return &dense_table_ptr->data[second_inner_page_addr];
+// bytes of an inner table node: the page_table wrapper, the table struct and its data array, in one piece
+static size_t inner_node_size(unsigned int number_of_pages, tableType type) {
+    if (type == DENSE_PAGE_TABLE) {
+        return sizeof(page_table) + sizeof(dense_page_table) + number_of_pages * sizeof(page_table_block);
+    }
+    return sizeof(page_table) + sizeof(two_level_page_table) + number_of_pages * sizeof(two_level_page_table_block);
+}
+
+// initialize an inner table inside a single arena node (inner tables are never freed one by one)
+static page_table* init_inner_page_table(node_arena **arena, unsigned int number_of_pages, tableType type) {
+    if (*arena == NULL) {
+        *arena = init_node_arena(inner_node_size(number_of_pages, type));
+    }
+    page_table *table = (page_table*) arena_alloc(*arena);
+    PROFILE_COUNT(inner_tables, 1);
+    table->type = type;
+    table->table_size = number_of_pages;
+
+    if (type == DENSE_PAGE_TABLE) {
+        dense_page_table *dense = (dense_page_table*) (table + 1);
+        dense->data = (page_table_block*) (dense + 1);
+        memset(dense->data, 0, number_of_pages * sizeof(page_table_block));
+        table->table = dense;
+    } else {
+        two_level_page_table *two_level = (two_level_page_table*) (table + 1);
+        two_level->data = (two_level_page_table_block*) (two_level + 1);
+        two_level->inner_nodes = NULL; // its inner tables come from the arena of the outer table
+        for (size_t i = 0; i < number_of_pages; i++) {
+            two_level->data[i].inner_table = NULL;
         }
-        // in three level tables, the outer table, the second inner table and the third inner table addresses are considered, since there are three tables
-        case THREE_LEVEL: {
-            dense_page_table* dense_table_ptr;
-            two_level_page_table* second_inner_table;
-            three_level_page_table* outer_table = (three_level_page_table*) table->table;
-
-            // checks if the second inner table is allocated already; if not, initialize it
-            if(outer_table->data[outer_page_addr].inner_table == NULL){
-                outer_table->data[outer_page_addr].inner_table = init_page_table(pow(2, second_inner_table_offset), TWO_LEVEL);
-                second_inner_table = (two_level_page_table*) outer_table->data[outer_page_addr].inner_table->table;
-
-                // also initialize the third inner page, since if the second isn't, the third also is not
-                second_inner_table->data[second_inner_page_addr].inner_table = init_page_table(pow(2, third_inner_table_offset), DENSE_PAGE_TABLE);
-                dense_table_ptr = (dense_page_table*) second_inner_table->data[second_inner_page_addr].inner_table->table;
-            }
+        table->table = two_level;
+    }
+    return table;
+}
 
-            second_inner_table = (two_level_page_table*) outer_table->data[outer_page_addr].inner_table->table;
+// returns the block of a two level table: the outer table and the second inner table addresses are considered
+page_table_block* get_page_two_level(page_table* table, int32_t outer_page_addr, int32_t second_inner_page_addr, uint32_t second_inner_table_offset){
+    dense_page_table* dense_table_ptr;
+    two_level_page_table* outer_table = (two_level_page_table*) table->table;
 
-            // checks if the third inner table is allocated already; if not, initialize it
-            if(second_inner_table->data[second_inner_page_addr].inner_table == NULL){
-                second_inner_table->data[second_inner_page_addr].inner_table = init_page_table(pow(2, third_inner_table_offset), DENSE_PAGE_TABLE);
-            }
+    // checks if the inner table is allocated already; if not, initialize it
+    if(outer_table->data[outer_page_addr].inner_table == NULL){
+        outer_table->data[outer_page_addr].inner_table = init_inner_page_table(&outer_table->inner_nodes, 1U << second_inner_table_offset, DENSE_PAGE_TABLE);
+    }
+    dense_table_ptr = (dense_page_table*) outer_table->data[outer_page_addr].inner_table->table;
+    return &dense_table_ptr->data[second_inner_page_addr];
+}
 
-            dense_table_ptr = (dense_page_table*) second_inner_table->data[second_inner_page_addr].inner_table->table;
-            return &dense_table_ptr->data[third_inner_page_addr];
+// returns the block of a three level table: the outer table, the second inner table and the third inner table addresses are considered
+page_table_block* get_page_three_level(page_table* table, int32_t outer_page_addr, int32_t second_inner_page_addr, int32_t third_inner_page_addr,
+                                       uint32_t second_inner_table_offset, uint32_t third_inner_table_offset){
+    dense_page_table* dense_table_ptr;
+    two_level_page_table* second_inner_table;
+    three_level_page_table* outer_table = (three_level_page_table*) table->table;
 
-        }
-        case INVERTED: // not possible: function only called when page table is not inverted
-            break;
+    // checks if the second inner table is allocated already; if not, initialize it
+    if(outer_table->data[outer_page_addr].inner_table == NULL){
+        outer_table->data[outer_page_addr].inner_table = init_inner_page_table(&outer_table->middle_nodes, 1U << second_inner_table_offset, TWO_LEVEL);
+        second_inner_table = (two_level_page_table*) outer_table->data[outer_page_addr].inner_table->table;
+
+        // also initialize the third inner page, since if the second isn't, the third also is not
+        second_inner_table->data[second_inner_page_addr].inner_table = init_inner_page_table(&outer_table->inner_nodes, 1U << third_inner_table_offset, DENSE_PAGE_TABLE);
+    }
+
+    second_inner_table = (two_level_page_table*) outer_table->data[outer_page_addr].inner_table->table;
+
+    // checks if the third inner table is allocated already; if not, initialize it
+    if(second_inner_table->data[second_inner_page_addr].inner_table == NULL){
+        second_inner_table->data[second_inner_page_addr].inner_table = init_inner_page_table(&outer_table->inner_nodes, 1U << third_inner_table_offset, DENSE_PAGE_TABLE);
     }
-    return NULL;
+
+    dense_table_ptr = (dense_page_table*) second_inner_table->data[second_inner_page_addr].inner_table->table;
+    return &dense_table_ptr->data[third_inner_page_addr];
 }
 
-// intermediary function that calls the specific replacement algorithms
-int replace_inverted_page_table_entry(const char *algorithm, inverted_page_table *table, size_t table_size){
-    if(strcmp(algorithm, "random") == 0) {
-        return random_replacement_inverted_table(table_size);
-    } else if(strcmp(algorithm, "lru") == 0) {
-        return lru_replacement_inverted_table(table, table_size);
-    } else if(strcmp(algorithm, "mfu") == 0) {
-        return mfu_replacement_inverted_table(table, table_size);
-    } else if(strcmp(algorithm, "lfu") == 0) {
-        return lfu_replacement_inverted_table(table, table_size);
+// creates a table of the given level of a radix table: pointers to the next level, or the page table
+// entries in the last level
+static void* init_radix_node(radix_page_table *table, int level) {
+    size_t slots = (size_t) 1 << table->bits[level];
+    bool last = level == table->levels - 1;
+    if (table->nodes[level] == NULL) {
+        table->nodes[level] = init_node_arena(slots * (last ? sizeof(page_table_block) : sizeof(void*)));
     }
-    return -1;
+    void *node = arena_alloc(table->nodes[level]);
+    PROFILE_COUNT(inner_tables, 1);
+    memset(node, 0, slots * (last ? sizeof(page_table_block) : sizeof(void*)));
+    return node;
 }
 
-// generates a random frame index between zero and table size (number of pages)
-int random_replacement_inverted_table(size_t table_size){
-    return random() % table_size;
+// returns the block of a four or five level table, creating the missing tables on the way down
+page_table_block* get_page_radix(page_table* table, uint64_t page){
+    radix_page_table* radix = (radix_page_table*) table->table;
+    void **node = radix->root;
+    int last = radix->levels - 1;
+    for (int l = 0; l < last; l++) {
+        size_t index = (page >> radix->shift[l]) & (((uint64_t) 1 << radix->bits[l]) - 1);
+        if (node[index] == NULL) {
+            node[index] = init_radix_node(radix, l + 1);
+        }
+        node = (void**) node[index];
+    }
+    return &((page_table_block*) node)[page & (((uint64_t) 1 << radix->bits[last]) - 1)];
 }
 
-// returns the index of the frame with the lowest last_access_moment value
-int lru_replacement_inverted_table(inverted_page_table *table, size_t table_size) {
-    int lru_index = -1;
-    int min_access_moment = __INT_MAX__;
+// 64 bit mixer (murmur3 finalizer) of the virtual page number into the buckets: the high bits of
+// 48 and 57 bit pages must reach the index. The address space is mixed in first (nothing changes for 0)
+static inline uint64_t hashed_table_hash(hashed_page_table *table, uint64_t page, uint32_t asid) {
+    page ^= asid * 0x9e3779b97f4a7c15ULL;
+    page ^= page >> 33;
+    page *= 0xff51afd7ed558ccdULL;
+    page ^= page >> 33;
+    return page & table->hash_mask;
+}
 
-    for (size_t i = 0; i < table_size; i++) {
-        if (table->data[i].last_access_moment < min_access_moment) {
-            min_access_moment = table->data[i].last_access_moment;
-            lru_index = i;
+// returns the block of the page of the address space in a hashed table; a page not in the table gets
+// an entry (the walk faults it in). Sets probes to the entries compared
+page_table_block* get_page_hashed(page_table* table, uint64_t page, uint32_t asid, unsigned int *probes){
+    hashed_page_table* hashed = (hashed_page_table*) table->table;
+    uint64_t hash = hashed_table_hash(hashed, page, asid);
+    unsigned int compared = 0;
+    hashed->lookups++;
+    for (int i = hashed->buckets[hash]; i != -1; i = hashed->entries[i].next) {
+        compared++;
+        if (hashed->entries[i].page == page && hashed->entries[i].asid == asid) {
+            hashed->probes += compared;
+            *probes = compared;
+            return &hashed->entries[i].block;
         }
     }
-    return lru_index;
+    hashed->probes += compared;
+    *probes = compared;
+
+    // there is always a free entry: every other entry holds a resident page
+    int index = hashed->free_entries;
+    hashed_page_table_entry *entry = &hashed->entries[index];
+    hashed->free_entries = entry->next;
+    entry->page = page;
+    entry->asid = asid;
+    entry->block = 0;
+    entry->next = hashed->buckets[hash];
+    hashed->buckets[hash] = index;
+    return &entry->block;
+}
+
+// the page of the block was evicted: its entry leaves the chain and goes back to the free list
+void hashed_table_remove(hashed_page_table *table, page_table_block *block) {
+    hashed_page_table_entry *entry = (hashed_page_table_entry*) block; // the block is the first member
+    int index = entry - table->entries;
+    int *link = &table->buckets[hashed_table_hash(table, entry->page, entry->asid)];
+    while (*link != index) {
+        link = &table->entries[*link].next;
+    }
+    *link = entry->next;
+    entry->next = table->free_entries;
+    table->free_entries = index;
 }
 
-// returns the index of the frame with the highest access_counter value
-int mfu_replacement_inverted_table(inverted_page_table *table, size_t mem_size) {
-    int mfu_index = -1;
-    int max_access_counter = -1;
+// multiplicative (fibonacci) hashing of the virtual page number and its address space into the anchor
+// table (the address space 0 leaves the page as it is)
+static inline uint32_t inverted_table_hash(inverted_page_table *table, int32_t page, uint32_t asid) {
+    uint32_t hash = ((uint32_t) page ^ asid * 0x85ebca6bU) * 2654435769U;
+    return (hash ^ (hash >> 16)) & table->hash_mask;
+}
 
-    for (size_t i = 0; i < mem_size; i++) {
-        if (table->data[i].access_counter > max_access_counter) {
-            max_access_counter = table->data[i].access_counter;
-            mfu_index = i;
+// returns the index of the entry holding the page of the address space, or -1 if the page is not in memory
+int inverted_table_lookup(inverted_page_table *table, int32_t page, uint32_t asid) {
+    table->hash_lookups++;
+    for (int i = table->hash_anchor[inverted_table_hash(table, page, asid)]; i != -1; i = table->next[i]) {
+        table->hash_probes++;
+        if (table->pages[i] == page && table->asids[i] == asid) {
+            return i;
         }
     }
-    return mfu_index;
+    return -1;
 }
 
-// returns the index of the frame with the lowest access_counter value
-int lfu_replacement_inverted_table(inverted_page_table *table, size_t mem_size) {
-    int lfu_index = -1;
-    int min_access_counter = __INT_MAX__;
+// associates the page of the address space with the entry and links the entry into the page hash chain
+void inverted_table_insert(inverted_page_table *table, int index, int32_t page, uint32_t asid) {
+    uint32_t hash = inverted_table_hash(table, page, asid);
+    table->pages[index] = page;
+    table->asids[index] = asid;
+    table->next[index] = table->hash_anchor[hash];
+    table->hash_anchor[hash] = index;
+}
 
-    for (size_t i = 0; i < mem_size; i++) {
-        if (table->data[i].access_counter < min_access_counter) {
-            min_access_counter = table->data[i].access_counter;
-            lfu_index = i;
+// unlinks the entry from its hash chain and marks it as free
+void inverted_table_remove(inverted_page_table *table, int index) {
+    int32_t page = table->pages[index];
+    if (page == -1) return;
+
+    int *link = &table->hash_anchor[inverted_table_hash(table, page, table->asids[index])];
+    while (*link != index) {
+        link = &table->next[*link];
+    }
+    *link = table->next[index];
+    table->next[index] = -1;
+    table->pages[index] = -1;
+    table->data[index] = 0;
+}
+
+// counts the tables, mallocs and bytes used by the page table (the outer table takes three mallocs:
+// wrapper, table struct and data array; inner tables are counted through their arenas)
+void get_page_table_usage(page_table* table, page_table_usage *usage){
+    usage->nodes = 1;
+    usage->allocations = 3;
+    usage->bytes = sizeof(page_table);
+
+    switch (table->type) {
+        case DENSE_PAGE_TABLE:
+            usage->bytes += sizeof(dense_page_table) + table->table_size * sizeof(page_table_block);
+            break;
+        case TWO_LEVEL: {
+            two_level_page_table* table_ptr = (two_level_page_table*) table->table;
+            usage->bytes += sizeof(two_level_page_table) + table->table_size * sizeof(two_level_page_table_block);
+            if (table_ptr->inner_nodes) {
+                usage->nodes += table_ptr->inner_nodes->node_count;
+                usage->allocations += 1 + table_ptr->inner_nodes->slab_count;
+                usage->bytes += sizeof(node_arena) + arena_bytes(table_ptr->inner_nodes);
+            }
+            break;
+        }
+        case THREE_LEVEL: {
+            three_level_page_table* table_ptr = (three_level_page_table*) table->table;
+            usage->bytes += sizeof(three_level_page_table) + table->table_size * sizeof(three_level_page_table_block);
+            node_arena *arenas[2] = { table_ptr->middle_nodes, table_ptr->inner_nodes };
+            for (int i = 0; i < 2; i++) {
+                if (arenas[i]) {
+                    usage->nodes += arenas[i]->node_count;
+                    usage->allocations += 1 + arenas[i]->slab_count;
+                    usage->bytes += sizeof(node_arena) + arena_bytes(arenas[i]);
+                }
+            }
+            break;
+        }
+        case INVERTED: {
+            // the hash anchor table and the page, address space and chain arrays are part of the inverted table
+            inverted_page_table* table_ptr = (inverted_page_table*) table->table;
+            usage->allocations += 4;
+            usage->bytes += sizeof(inverted_page_table) + table->table_size * (sizeof(page_table_block) + sizeof(int32_t) + sizeof(uint32_t) + sizeof(int)) +
+                            (table_ptr->hash_mask + 1) * sizeof(int);
+            break;
+        }
+        case FOUR_LEVEL:
+        case FIVE_LEVEL: {
+            // the outer table takes three mallocs too (wrapper, table struct and root array)
+            radix_page_table* table_ptr = (radix_page_table*) table->table;
+            usage->bytes += sizeof(radix_page_table) + table->table_size * sizeof(void*);
+            for (int l = 1; l < table_ptr->levels; l++) {
+                if (table_ptr->nodes[l]) {
+                    usage->nodes += table_ptr->nodes[l]->node_count;
+                    usage->allocations += 1 + table_ptr->nodes[l]->slab_count;
+                    usage->bytes += sizeof(node_arena) + arena_bytes(table_ptr->nodes[l]);
+                }
+            }
+            break;
+        }
+        case HASHED: {
+            // the entries and the buckets are one malloc each besides the wrapper and table struct
+            hashed_page_table* table_ptr = (hashed_page_table*) table->table;
+            usage->allocations++;
+            usage->bytes += sizeof(hashed_page_table) + (table->table_size + 1) * sizeof(hashed_page_table_entry) +
+                            (table_ptr->hash_mask + 1) * sizeof(int);
+            break;
         }
     }
-    return lfu_index;
 }
 
 // set the each table offset accordind to its type
@@ -275,8 +536,15 @@ void set_tables_offset(tableType type, uint32_t offset,  uint32_t *outer_table_o
             *second_inner_table_offset = (ADDRESS_SIZE - offset) / 3;
             *outer_table_offset = (ADDRESS_SIZE - offset) - *second_inner_table_offset - *third_inner_table_offset;
             break;
-        // inverted page tables will get the number of frames as the offset
+        // inverted and hashed page tables will get the number of frames as the offset; four and five
+        // level tables split the page number themselves (see init_radix_page_table)
         case INVERTED:
+        case FOUR_LEVEL:
+        case FIVE_LEVEL:
+        case HASHED:
+            *outer_table_offset = 0;
+            *second_inner_table_offset = 0;
+            *third_inner_table_offset = 0;
             break;
     }
 }
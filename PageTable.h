@@ -2,14 +2,22 @@
 #define PAGE_H
 
 #define ADDRESS_SIZE 32
+#define FOUR_LEVEL_ADDRESS_SIZE 48 // x86-64 virtual addresses with 4-level paging
+#define FIVE_LEVEL_ADDRESS_SIZE 57 // x86-64 virtual addresses with 5-level paging (LA57)
+#define HASHED_ADDRESS_SIZE 64
+#define RADIX_MAX_LEVELS 5
 
 #include <stdlib.h>
 #include <stdbool.h>
 #include <stdint.h>
 #include <string.h>
 #include <math.h>
+#include "Recency.h"
+#include "Frequency.h"
+#include "FreeFrames.h"
+#include "Arena.h"
 
-typedef enum { DENSE_PAGE_TABLE, TWO_LEVEL, THREE_LEVEL, INVERTED } tableType;
+typedef enum { DENSE_PAGE_TABLE, TWO_LEVEL, THREE_LEVEL, INVERTED, FOUR_LEVEL, FIVE_LEVEL, HASHED } tableType;
 
 typedef struct {
     void* table; // void pointer can have any table type instantiated to it
@@ -19,10 +27,15 @@ typedef struct {
 
 /* ============ BLOCKS ============ */
 
-typedef struct {
-    bool valid; // true if the associated page is in memory
-    int frame; // reference to the memory frame
-} page_table_block;
+// page table entry packed in 32 bits: the valid, referenced and modified bits above the frame number.
+// The all-zero entry is invalid, so tables start out zeroed
+typedef uint32_t page_table_block;
+
+#define PTE_VALID (1U << 31) // the associated page is in memory
+#define PTE_REFERENCED (1U << 30) // set on every access to the page, cleared by the clock hand
+#define PTE_MODIFIED (1U << 29) // set on every write to the page while it is in memory
+#define PTE_FRAME_MASK (PTE_MODIFIED - 1) // memory frame holding the page
+#define PTE_MAX_FRAMES (PTE_FRAME_MASK + 1)
 
 typedef struct {
     page_table *inner_table;
@@ -32,14 +45,13 @@ typedef struct {
     page_table *inner_table;
 } three_level_page_table_block;
 
-// inverted page table simulates the physical memory
+// entry of a hashed page table: the page table entry of one resident page, chained by page hash
 typedef struct {
-    int frame;
-    bool modified;
-    int32_t page;
-    int last_access_moment;
-    int access_counter;
-} inverted_page_table_block;
+    page_table_block block;
+    int next; // next entry in the same chain, or in the free list (-1 ends it)
+    uint32_t asid; // address space (process) of the page; 0 in single-process runs
+    uint64_t page;
+} hashed_page_table_entry;
 
 /* ================================ */
 
@@ -51,18 +63,74 @@ typedef struct {
 
 typedef struct {
     two_level_page_table_block* data;
+    node_arena *inner_nodes; // inner (dense) tables, created on the first page fault
 } two_level_page_table;
 
 typedef struct {
     three_level_page_table_block* data;
+    node_arena *middle_nodes; // second level (two level) tables
+    node_arena *inner_nodes; // third level (dense) tables
 } three_level_page_table;
 
+// inverted page table simulates the physical memory: entry i belongs to frame i. Each attribute of
+// the entries is its own array
 typedef struct {
-    inverted_page_table_block* data;
+    page_table_block* data; // valid, referenced and modified bits (the frame is the entry itself)
+    int32_t *pages; // page held by each entry (-1 if free)
+    uint32_t *asids; // address space (process) of the page held by each entry; 0 in single-process runs
+    int *next; // next entry in the same hash chain (-1 ends the chain)
+    int *hash_anchor; // hash anchor table: first entry of each chain, indexed by the page hash (-1 if empty)
+    uint32_t hash_mask; // number of anchors - 1 (the anchor table size is a power of two)
+    free_frame_pool *free_entries; // entries not associated with any page
+    unsigned long hash_lookups;
+    unsigned long hash_probes; // entries compared across every lookup
+    recency_list *recency; // entries in access order, used in lru
+    frequency_table *frequency; // entries grouped by access count, used in lfu and mfu
 } inverted_page_table;
 
+// radix table of 4 or 5 levels for 48 and 57 bit address spaces: the page number is split evenly
+// between the levels (the outer one takes the remainder). Only the outer table is allocated up front,
+// a table of each lower level is created on the first fault that needs it
+typedef struct {
+    int levels;
+    uint32_t bits[RADIX_MAX_LEVELS]; // index bits of each level, outer first
+    uint32_t shift[RADIX_MAX_LEVELS]; // position of each index in the page number
+    void **root; // tables above the last level hold pointers, the last level holds page_table_blocks
+    node_arena *nodes[RADIX_MAX_LEVELS]; // tables of each level below the outer one
+} radix_page_table;
+
+// hashed page table: a chained hash of the page table entries of the resident pages, so its size
+// follows physical memory instead of the address space. An entry is added by the walk that faults
+// the page in and dropped when the page is evicted. Like the inverted table, one table serves every
+// process: entries are tagged with the address space of their page
+typedef struct {
+    hashed_page_table_entry *entries; // one per frame, plus the page coming in while the victim leaves
+    int *buckets; // first entry of each chain (-1 if empty)
+    uint64_t hash_mask; // number of buckets - 1 (a power of two)
+    int free_entries; // first entry of the free list
+    unsigned long lookups;
+    unsigned long probes; // entries compared across every lookup
+} hashed_page_table;
+
 /* ===================================== */
 
+// memory used by a page table
+typedef struct {
+    size_t nodes; // tables (outer and inner) allocated
+    size_t allocations; // calls to malloc made for them
+    size_t bytes;
+} page_table_usage;
+
+// entry of a page just brought into the frame: valid and referenced, modified if the access is a write
+static inline page_table_block make_pte(unsigned int frame, bool modified) {
+    return PTE_VALID | PTE_REFERENCED | (modified ? PTE_MODIFIED : 0) | frame;
+}
+
+// frame of a valid entry
+static inline unsigned int pte_frame(page_table_block pte) {
+    return pte & PTE_FRAME_MASK;
+}
+
 /* ============ FUNCTIONS ============ */
 
 page_table* init_page_table(unsigned int outer_table_offset, tableType type);
@@ -75,8 +143,22 @@ three_level_page_table* init_three_level_page_table(unsigned int outer_table_off
 
 inverted_page_table* init_inverted_page_table(unsigned int outer_table_offset);
 
-page_table_block* get_page(page_table* table, int32_t outer_page_addr, int32_t second_inner_page_addr, int32_t third_inner_page_addr,
-                           uint32_t second_inner_table_offset, uint32_t third_inner_table_offset);
+page_table* init_radix_page_table(tableType type, uint32_t page_bits);
+
+hashed_page_table* init_hashed_page_table(unsigned int number_of_frames);
+
+uint32_t table_address_size(tableType type);
+
+page_table_block* get_page_two_level(page_table* table, int32_t outer_page_addr, int32_t second_inner_page_addr, uint32_t second_inner_table_offset);
+
+page_table_block* get_page_three_level(page_table* table, int32_t outer_page_addr, int32_t second_inner_page_addr, int32_t third_inner_page_addr,
+                                       uint32_t second_inner_table_offset, uint32_t third_inner_table_offset);
+
+page_table_block* get_page_radix(page_table* table, uint64_t page);
+
+page_table_block* get_page_hashed(page_table* table, uint64_t page, uint32_t asid, unsigned int *probes);
+
+void hashed_table_remove(hashed_page_table *table, page_table_block *block);
 
 void free_page_table(page_table* table, tableType type);
 
@@ -88,17 +170,19 @@ void free_three_level_page_table(page_table* table);
 
 void free_inverted_page_table(page_table* table);
 
-void set_tables_offset(tableType type, uint32_t offset,  uint32_t *outer_table_offset, uint32_t *second_inner_table_offset, uint32_t *third_inner_table_offset);
+void free_radix_page_table(page_table* table);
 
-int replace_inverted_page_table_entry(const char *algorithm, inverted_page_table *table, size_t table_size);
+void free_hashed_page_table(page_table* table);
 
-int random_replacement_inverted_table(size_t table_size);
+void get_page_table_usage(page_table* table, page_table_usage *usage);
+
+void set_tables_offset(tableType type, uint32_t offset,  uint32_t *outer_table_offset, uint32_t *second_inner_table_offset, uint32_t *third_inner_table_offset);
 
-int lru_replacement_inverted_table(inverted_page_table *table, size_t table_size);
+int inverted_table_lookup(inverted_page_table *table, int32_t page, uint32_t asid);
 
-int mfu_replacement_inverted_table(inverted_page_table *table, size_t mem_size);
+void inverted_table_insert(inverted_page_table *table, int index, int32_t page, uint32_t asid);
 
-int lfu_replacement_inverted_table(inverted_page_table *table, size_t mem_size);
+void inverted_table_remove(inverted_page_table *table, int index);
 
 /* =================================== */
 
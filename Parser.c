@@ -0,0 +1,327 @@
+#define _GNU_SOURCE // memrchr
+#include "Parser.h"
+#include <string.h>
+#include <unistd.h>
+#include <poll.h>
+#include <errno.h>
+
+// SWAR helpers: eight characters are classified and decoded at once in a 64-bit word
+#define ONES 0x0101010101010101ULL
+#define HIGHS 0x8080808080808080ULL
+
+// high bit set in every byte of x that is strictly between m and n (0 <= m <= 127, n <= 128)
+#define BYTES_BETWEEN(x, m, n) \
+    ((((ONES * (127 + (n))) - ((x) & (ONES * 127))) & ~(x) & (((x) & (ONES * 127)) + (ONES * (127 - (m))))) & HIGHS)
+
+static inline bool is_space(char c) {
+    return c == ' ' || c == '\n' || c == '\t' || c == '\r' || c == '\v' || c == '\f';
+}
+
+static inline int hex_value(char c) {
+    if (c >= '0' && c <= '9') return c - '0';
+    if ((c | 0x20) >= 'a' && (c | 0x20) <= 'f') return (c | 0x20) - 'a' + 10;
+    return -1;
+}
+
+// eight characters as a word, first character in the lowest byte
+static inline uint64_t load_word(const char *p) {
+    uint64_t word;
+    memcpy(&word, p, sizeof(word));
+#if __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+    word = __builtin_bswap64(word);
+#endif
+    return word;
+}
+
+// number of hex digits at the start of the word (0 to 8)
+static inline size_t hex_digits(uint64_t word) {
+    uint64_t lower = word | (ONES * 0x20);
+    uint64_t hex = BYTES_BETWEEN(word, '0' - 1, '9' + 1) | BYTES_BETWEEN(lower, 'a' - 1, 'f' + 1);
+    uint64_t other = ~hex & HIGHS;
+    return other ? (size_t) __builtin_ctzll(other) / 8 : 8;
+}
+
+// value of the first `digits` (1 to 8) hex digits of the word. The digits are moved to the top
+// bytes (zeros come in as leading zero digits), turned into nibbles and packed pairwise
+static inline uint32_t decode_hex(uint64_t word, size_t digits) {
+    word <<= (8 - digits) * 8;
+    uint64_t nibbles = (word & (ONES * 0x0F)) + 9 * ((word >> 6) & ONES); // letters have bit 6 set
+    nibbles = ((nibbles & 0x000F000F000F000FULL) << 4) | ((nibbles >> 8) & 0x000F000F000F000FULL);
+    nibbles = ((nibbles & 0x000000FF000000FFULL) << 8) | ((nibbles >> 16) & 0x000000FF000000FFULL);
+    nibbles = ((nibbles & 0x000000000000FFFFULL) << 16) | ((nibbles >> 32) & 0x000000000000FFFFULL);
+    return (uint32_t) nibbles;
+}
+
+static void grow_chunk_output(parse_chunk *chunk) {
+    chunk->capacity *= 2;
+    chunk->addresses = (uint64_t*) realloc(chunk->addresses, chunk->capacity * sizeof(uint64_t));
+    chunk->operations = (char*) realloc(chunk->operations, chunk->capacity * sizeof(char));
+    chunk->pids = (uint32_t*) realloc(chunk->pids, chunk->capacity * sizeof(uint32_t));
+}
+
+// decodes the "%lx %c [pid]" records of a chunk, accepting what fscanf accepts in practice: any whitespace
+// around the fields and an optional 0x prefix. The process id is a decimal number on the same line as
+// the operation; lines without it belong to process 0. Returns the number of accesses
+size_t parse_text_chunk(parse_chunk *chunk) {
+    const char *p = chunk->text;
+    const char *end = chunk->text + chunk->length;
+    chunk->count = 0;
+    chunk->has_pids = false;
+    chunk->wide = false;
+    chunk->malformed = false;
+
+    while (true) {
+        while (p < end && is_space(*p)) p++;
+        if (p >= end) break;
+
+        if (p[0] == '0' && (p[1] | 0x20) == 'x' && hex_value(p[2]) != -1) p += 2;
+        uint64_t word = load_word(p); // the padding after the text keeps this inside the buffer
+        size_t digits = hex_digits(word);
+        if (digits == 0) {
+            chunk->malformed = true;
+            break;
+        }
+        uint64_t addr = decode_hex(word, digits);
+        p += digits;
+        if (digits == 8) { // 64-bit addresses: the next eight digits, then one at a time (keeping the low 64 bits)
+            word = load_word(p);
+            digits = hex_digits(word);
+            if (digits > 0) {
+                addr = (addr << (4 * digits)) | decode_hex(word, digits);
+                p += digits;
+            }
+            int value;
+            while (digits == 8 && (value = hex_value(*p)) != -1) {
+                addr = (addr << 4) | value;
+                p++;
+            }
+            if (addr > UINT32_MAX) chunk->wide = true;
+        }
+
+        while (p < end && is_space(*p)) p++;
+        if (p >= end) {
+            chunk->malformed = true;
+            break;
+        }
+
+        if (chunk->count == chunk->capacity) grow_chunk_output(chunk);
+        chunk->addresses[chunk->count] = addr;
+        chunk->operations[chunk->count] = *p++;
+
+        while (p < end && (*p == ' ' || *p == '\t')) p++;
+        uint32_t pid = 0;
+        if (p < end && *p >= '0' && *p <= '9') {
+            chunk->has_pids = true;
+            while (p < end && *p >= '0' && *p <= '9') pid = pid * 10 + (*p++ - '0');
+        }
+        chunk->pids[chunk->count] = pid;
+        chunk->count++;
+    }
+    return chunk->count;
+}
+
+// reads until `size` bytes arrive or the input ends (pipes deliver partial reads); returns the bytes read.
+// It waits in poll() on the wakeup pipe too, so stopping does not hang on a pipe that stays open
+static size_t read_fully(trace_pipeline *pipeline, char *buffer, size_t size) {
+    struct pollfd fds[2] = { { pipeline->fd, POLLIN, 0 }, { pipeline->wakeup[0], POLLIN, 0 } };
+    size_t total = 0;
+    while (total < size) {
+        if (poll(fds, 2, -1) < 0) {
+            if (errno == EINTR) continue;
+            break;
+        }
+        if (fds[1].revents != 0) break; // stop_trace_pipeline closed the pipe
+        ssize_t n = read(pipeline->fd, buffer + total, size - total);
+        if (n <= 0) break;
+        total += n;
+    }
+    return total;
+}
+
+// reader thread: fills the slots in order, each with whole lines; the partial line at the end of a
+// read is carried to the front of the next chunk
+static void* pipeline_reader(void *arg) {
+    trace_pipeline *pipeline = (trace_pipeline*) arg;
+    char *carry = (char*) malloc(PARSE_CHUNK_SIZE);
+    size_t carry_length = 0;
+
+    for (unsigned long sequence = 0;; sequence++) {
+        parse_chunk *chunk = &pipeline->chunks[sequence % pipeline->slots];
+        pthread_mutex_lock(&pipeline->lock);
+        while (chunk->state != CHUNK_EMPTY && !pipeline->stopping) {
+            pthread_cond_wait(&pipeline->can_read, &pipeline->lock);
+        }
+        bool stopping = pipeline->stopping;
+        pthread_mutex_unlock(&pipeline->lock);
+        if (stopping) break;
+
+        memcpy(chunk->text, carry, carry_length);
+        size_t read_length = read_fully(pipeline, chunk->text + carry_length, PARSE_CHUNK_SIZE);
+        pthread_mutex_lock(&pipeline->lock);
+        stopping = pipeline->stopping;
+        pthread_mutex_unlock(&pipeline->lock);
+        if (stopping) break;
+        size_t length = carry_length + read_length;
+        bool last = read_length < PARSE_CHUNK_SIZE;
+        carry_length = 0;
+        if (!last) {
+            char *newline = memrchr(chunk->text, '\n', length);
+            if (newline != NULL) { // a line longer than a chunk is simply cut
+                carry_length = chunk->text + length - (newline + 1);
+                memcpy(carry, newline + 1, carry_length);
+                length -= carry_length;
+            }
+        }
+        memset(chunk->text + length, 0, sizeof(uint64_t));
+        chunk->length = length;
+        chunk->last = last;
+
+        pthread_mutex_lock(&pipeline->lock);
+        chunk->state = CHUNK_READ;
+        pthread_cond_broadcast(&pipeline->can_parse);
+        pthread_mutex_unlock(&pipeline->lock);
+        if (last) break;
+    }
+    free(carry);
+    return NULL;
+}
+
+// worker thread: claims the chunks in order and decodes them, possibly several at the same time
+static void* pipeline_worker(void *arg) {
+    trace_pipeline *pipeline = (trace_pipeline*) arg;
+    pthread_mutex_lock(&pipeline->lock);
+    while (true) {
+        parse_chunk *chunk = &pipeline->chunks[pipeline->next_parse % pipeline->slots];
+        while (!pipeline->stopping && !pipeline->parse_done && chunk->state != CHUNK_READ) {
+            pthread_cond_wait(&pipeline->can_parse, &pipeline->lock);
+            chunk = &pipeline->chunks[pipeline->next_parse % pipeline->slots];
+        }
+        if (pipeline->stopping || pipeline->parse_done) break;
+
+        chunk->state = CHUNK_PARSING;
+        pipeline->next_parse++;
+        if (chunk->last) {
+            pipeline->parse_done = true;
+            pthread_cond_broadcast(&pipeline->can_parse); // the other workers can leave
+        }
+        pthread_mutex_unlock(&pipeline->lock);
+
+        parse_text_chunk(chunk);
+
+        pthread_mutex_lock(&pipeline->lock);
+        chunk->state = CHUNK_PARSED;
+        pthread_cond_broadcast(&pipeline->can_consume);
+    }
+    pthread_mutex_unlock(&pipeline->lock);
+    return NULL;
+}
+
+// starts reading a text trace from the descriptor (a file, a pipe or stdin) with `threads` parsing workers;
+// returns NULL if the wakeup pipe cannot be created (the descriptor is left open)
+trace_pipeline* start_trace_pipeline(int fd, int threads) {
+    if (threads < 1) threads = 1;
+    if (threads > PARSE_MAX_THREADS) threads = PARSE_MAX_THREADS;
+
+    trace_pipeline *pipeline = (trace_pipeline*) calloc(1, sizeof(trace_pipeline));
+    pipeline->fd = fd;
+    if (pipe(pipeline->wakeup) != 0) {
+        free(pipeline);
+        return NULL;
+    }
+    pipeline->threads = threads;
+    pipeline->slots = threads + 2; // one being read, one being consumed and one per worker
+    pipeline->chunks = (parse_chunk*) calloc(pipeline->slots, sizeof(parse_chunk));
+    for (size_t i = 0; i < pipeline->slots; i++) {
+        parse_chunk *chunk = &pipeline->chunks[i];
+        chunk->text = (char*) malloc(2 * PARSE_CHUNK_SIZE + sizeof(uint64_t));
+        chunk->capacity = PARSE_CHUNK_SIZE / 8; // about the number of lines of a chunk of "%08x %c" lines
+        chunk->addresses = (uint64_t*) malloc(chunk->capacity * sizeof(uint64_t));
+        chunk->operations = (char*) malloc(chunk->capacity * sizeof(char));
+        chunk->pids = (uint32_t*) malloc(chunk->capacity * sizeof(uint32_t));
+        chunk->state = CHUNK_EMPTY;
+    }
+    pthread_mutex_init(&pipeline->lock, NULL);
+    pthread_cond_init(&pipeline->can_read, NULL);
+    pthread_cond_init(&pipeline->can_parse, NULL);
+    pthread_cond_init(&pipeline->can_consume, NULL);
+
+    pipeline->workers = (pthread_t*) malloc(threads * sizeof(pthread_t));
+    pthread_create(&pipeline->reader, NULL, pipeline_reader, pipeline);
+    for (int t = 0; t < threads; t++) {
+        pthread_create(&pipeline->workers[t], NULL, pipeline_worker, pipeline);
+    }
+    return pipeline;
+}
+
+// copies up to `max` accesses, in trace order, into the arrays (the process ids only if `pids` is not
+// NULL); returns how many (0 at the end of the trace)
+size_t pipeline_next(trace_pipeline *pipeline, uint64_t *addresses, char *operations, uint32_t *pids, size_t max) {
+    size_t n = 0;
+    while (n < max && !pipeline->ended) {
+        parse_chunk *chunk = &pipeline->chunks[pipeline->next_consume % pipeline->slots];
+        if (!pipeline->consuming) {
+            pthread_mutex_lock(&pipeline->lock);
+            while (chunk->state != CHUNK_PARSED) {
+                pthread_cond_wait(&pipeline->can_consume, &pipeline->lock);
+            }
+            pthread_mutex_unlock(&pipeline->lock);
+            pipeline->consuming = true;
+            pipeline->position = 0;
+            pipeline->has_pids |= chunk->has_pids;
+            pipeline->wide |= chunk->wide;
+        }
+
+        size_t available = chunk->count - pipeline->position;
+        size_t take = available < max - n ? available : max - n;
+        memcpy(addresses + n, chunk->addresses + pipeline->position, take * sizeof(uint64_t));
+        memcpy(operations + n, chunk->operations + pipeline->position, take * sizeof(char));
+        if (pids) memcpy(pids + n, chunk->pids + pipeline->position, take * sizeof(uint32_t));
+        n += take;
+        pipeline->position += take;
+
+        if (pipeline->position == chunk->count) {
+            if (chunk->last || chunk->malformed) {
+                pipeline->ended = true;
+                break;
+            }
+            pthread_mutex_lock(&pipeline->lock);
+            chunk->state = CHUNK_EMPTY;
+            pthread_cond_signal(&pipeline->can_read);
+            pthread_mutex_unlock(&pipeline->lock);
+            pipeline->consuming = false;
+            pipeline->next_consume++;
+        }
+    }
+    return n;
+}
+
+// stops the threads (the input may not have been read to the end) and frees the pipeline
+void stop_trace_pipeline(trace_pipeline *pipeline) {
+    if (pipeline == NULL) return;
+    pthread_mutex_lock(&pipeline->lock);
+    pipeline->stopping = true;
+    pthread_cond_broadcast(&pipeline->can_read);
+    pthread_cond_broadcast(&pipeline->can_parse);
+    pthread_mutex_unlock(&pipeline->lock);
+    close(pipeline->wakeup[1]); // wakes the reader if it is waiting for input
+
+    pthread_join(pipeline->reader, NULL);
+    for (int t = 0; t < pipeline->threads; t++) {
+        pthread_join(pipeline->workers[t], NULL);
+    }
+    for (size_t i = 0; i < pipeline->slots; i++) {
+        free(pipeline->chunks[i].text);
+        free(pipeline->chunks[i].addresses);
+        free(pipeline->chunks[i].operations);
+        free(pipeline->chunks[i].pids);
+    }
+    free(pipeline->chunks);
+    free(pipeline->workers);
+    pthread_mutex_destroy(&pipeline->lock);
+    pthread_cond_destroy(&pipeline->can_read);
+    pthread_cond_destroy(&pipeline->can_parse);
+    pthread_cond_destroy(&pipeline->can_consume);
+    close(pipeline->wakeup[0]);
+    close(pipeline->fd);
+    free(pipeline);
+}
@@ -0,0 +1,71 @@
+#ifndef PARSER_H
+#define PARSER_H
+
+#include <stdlib.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <pthread.h>
+
+#define PARSE_CHUNK_SIZE (1 << 20) // bytes read at a time; chunks are cut at the last newline
+#define PARSE_MAX_THREADS 8
+
+typedef enum { CHUNK_EMPTY, CHUNK_READ, CHUNK_PARSING, CHUNK_PARSED } chunkState;
+
+// one slot of the pipeline: a piece of text made of whole lines and the accesses decoded from it
+typedef struct {
+    char *text; // PARSE_CHUNK_SIZE plus the carried partial line, plus 8 zero bytes of padding
+    size_t length;
+    uint64_t *addresses;
+    char *operations;
+    uint32_t *pids; // process of each access (0 if its line has no third column)
+    size_t count;
+    size_t capacity;
+    bool has_pids; // some line of the chunk has a process id
+    bool wide; // some address of the chunk needs more than 32 bits
+    bool last; // end of the input
+    bool malformed; // parsing stopped at a line that is not "%lx %c [pid]": the trace ends there, as with fscanf
+    chunkState state;
+} parse_chunk;
+
+// text trace pipeline: a reader thread cuts the input into chunks of whole lines, worker threads
+// decode them in parallel and the simulation takes them back in order. The slots form a bounded
+// queue, so a fast reader never gets more than a few chunks ahead of the simulation
+typedef struct {
+    int fd;
+    int wakeup[2]; // pipe closed by stop_trace_pipeline, so a reader waiting on fd leaves at once
+    parse_chunk *chunks;
+    size_t slots;
+    unsigned long next_parse; // next chunk to be claimed by a worker
+    bool parse_done; // the last chunk was claimed
+    bool stopping;
+    pthread_mutex_t lock; // guards the fields above and the chunk states
+    pthread_cond_t can_read;
+    pthread_cond_t can_parse;
+    pthread_cond_t can_consume;
+    pthread_t reader;
+    pthread_t *workers;
+    int threads;
+
+    // only used by the consuming thread, without the lock: kept apart from the flags the other
+    // threads read and write under it
+    unsigned long next_consume; // chunk being consumed
+    size_t position; // next access of the chunk being consumed
+    bool consuming; // the chunk being consumed was taken from the queue
+    bool ended; // everything was consumed
+    bool has_pids; // some chunk consumed so far has process ids
+    bool wide; // some chunk consumed so far has addresses above 32 bits
+} trace_pipeline;
+
+/* ============ FUNCTIONS ============ */
+
+trace_pipeline* start_trace_pipeline(int fd, int threads);
+
+size_t pipeline_next(trace_pipeline *pipeline, uint64_t *addresses, char *operations, uint32_t *pids, size_t max);
+
+void stop_trace_pipeline(trace_pipeline *pipeline);
+
+size_t parse_text_chunk(parse_chunk *chunk);
+
+/* =================================== */
+
+#endif
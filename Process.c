@@ -0,0 +1,77 @@
+#include "Process.h"
+#include <string.h>
+
+#define PROCESS_INITIAL_CAPACITY 16
+
+static inline size_t hash_pid(uint32_t pid) {
+    return (pid * 2654435769U) ^ (pid >> 16);
+}
+
+// slot of the pid in the hash: the one holding it, or the empty one where it would go
+static size_t find_slot(const process_table *table, uint32_t pid) {
+    size_t slot = hash_pid(pid) & table->hash_mask;
+    while (table->hash[slot] != -1 && table->list[table->hash[slot]].pid != pid) {
+        slot = (slot + 1) & table->hash_mask;
+    }
+    return slot;
+}
+
+// initialize an empty table of processes
+process_table* init_process_table(void) {
+    process_table *table = (process_table*) malloc(sizeof(process_table));
+    if (!table) return NULL;
+    table->count = 0;
+    table->capacity = PROCESS_INITIAL_CAPACITY;
+    table->list = (process*) malloc(table->capacity * sizeof(process));
+    table->hash_mask = 2 * PROCESS_INITIAL_CAPACITY - 1;
+    table->hash = (int*) malloc((table->hash_mask + 1) * sizeof(int));
+    if (!table->list || !table->hash) {
+        free_process_table(table);
+        return NULL;
+    }
+    memset(table->hash, 0xff, (table->hash_mask + 1) * sizeof(int));
+    return table;
+}
+
+// index of the process, or -1 if it has not been seen
+int find_process(process_table *table, uint32_t pid) {
+    return table->hash[find_slot(table, pid)];
+}
+
+// adds a process not yet in the table, with no page table and zeroed counters; returns its index, or
+// -1 if there are already PROCESS_MAX processes or memory can't be allocated
+int add_process(process_table *table, uint32_t pid) {
+    if (table->count == PROCESS_MAX) return -1;
+    if (table->count == table->capacity) {
+        process *list = (process*) realloc(table->list, 2 * table->capacity * sizeof(process));
+        int *hash = (int*) malloc(4 * table->capacity * sizeof(int));
+        if (!list || !hash) {
+            if (list) table->list = list;
+            free(hash);
+            return -1;
+        }
+        table->list = list;
+        table->capacity *= 2;
+        free(table->hash);
+        table->hash = hash;
+        table->hash_mask = 2 * table->capacity - 1;
+        memset(table->hash, 0xff, (table->hash_mask + 1) * sizeof(int));
+        for (size_t i = 0; i < table->count; i++) {
+            table->hash[find_slot(table, table->list[i].pid)] = i;
+        }
+    }
+
+    int index = table->count++;
+    memset(&table->list[index], 0, sizeof(process));
+    table->list[index].pid = pid;
+    table->hash[find_slot(table, pid)] = index;
+    return index;
+}
+
+// frees the table; the page tables of the processes belong to the simulation, which frees them
+void free_process_table(process_table *table) {
+    if (table == NULL) return;
+    free(table->list);
+    free(table->hash);
+    free(table);
+}
@@ -0,0 +1,43 @@
+#ifndef PROCESS_H
+#define PROCESS_H
+
+#include <stdlib.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include "PageTable.h"
+
+#define PROCESS_MAX 65536 // address spaces a simulation tells apart (the TLB tags entries with 16 bits)
+
+// one process of a multi-process trace: its address space and what happened to it
+typedef struct {
+    uint32_t pid;
+    page_table *page_table; // its own table, created on its first access (NULL for inverted and hashed tables, shared by every process)
+    unsigned long accesses;
+    unsigned int page_faults;
+    unsigned int dirty_pages; // its modified pages written back to the disk
+    unsigned int resident; // frames holding its pages
+    unsigned int peak_resident;
+} process;
+
+// processes in order of their first access; the index of a process is its address space identifier
+typedef struct {
+    process *list;
+    size_t count;
+    size_t capacity;
+    int *hash; // pid -> index in list (-1 if the slot is empty), open addressing
+    size_t hash_mask;
+} process_table;
+
+/* ============ FUNCTIONS ============ */
+
+process_table* init_process_table(void);
+
+int find_process(process_table *table, uint32_t pid);
+
+int add_process(process_table *table, uint32_t pid);
+
+void free_process_table(process_table *table);
+
+/* =================================== */
+
+#endif
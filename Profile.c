@@ -0,0 +1,86 @@
+#include "Profile.h"
+
+#ifdef PROFILE
+
+#include <string.h>
+#include <unistd.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <linux/perf_event.h>
+
+#define HARDWARE_COUNTERS 4
+
+profile_counters profile;
+
+static const char *phase_names[PROFILE_PHASES] = { "parse", "address split", "page walk", "hit/fault handling", "replacement", "debug log" };
+
+static const struct {
+    const char *name;
+    uint64_t config;
+} hardware_events[HARDWARE_COUNTERS] = {
+    { "cycles", PERF_COUNT_HW_CPU_CYCLES },
+    { "instructions", PERF_COUNT_HW_INSTRUCTIONS },
+    { "cache misses", PERF_COUNT_HW_CACHE_MISSES },
+    { "branch misses", PERF_COUNT_HW_BRANCH_MISSES },
+};
+
+static int hardware_fds[HARDWARE_COUNTERS] = { -1, -1, -1, -1 };
+static uint64_t hardware_values[HARDWARE_COUNTERS];
+
+// opens and starts the hardware counters of this process (user space only). Counters the kernel or
+// the machine do not offer are left closed and reported as unavailable
+void start_hardware_counters(void) {
+    for (int i = 0; i < HARDWARE_COUNTERS; i++) {
+        struct perf_event_attr attr;
+        memset(&attr, 0, sizeof(attr));
+        attr.size = sizeof(attr);
+        attr.type = PERF_TYPE_HARDWARE;
+        attr.config = hardware_events[i].config;
+        attr.disabled = 1;
+        attr.exclude_kernel = 1;
+        attr.exclude_hv = 1;
+        hardware_fds[i] = syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0);
+        if (hardware_fds[i] != -1) {
+            ioctl(hardware_fds[i], PERF_EVENT_IOC_RESET, 0);
+            ioctl(hardware_fds[i], PERF_EVENT_IOC_ENABLE, 0);
+        }
+    }
+}
+
+void stop_hardware_counters(void) {
+    for (int i = 0; i < HARDWARE_COUNTERS; i++) {
+        if (hardware_fds[i] == -1) continue;
+        ioctl(hardware_fds[i], PERF_EVENT_IOC_DISABLE, 0);
+        if (read(hardware_fds[i], &hardware_values[i], sizeof(uint64_t)) != sizeof(uint64_t)) {
+            close(hardware_fds[i]);
+            hardware_fds[i] = -1;
+            continue;
+        }
+        close(hardware_fds[i]);
+        hardware_fds[i] = -2; // read
+    }
+}
+
+// per-phase totals and the counters, printed after the simulation summary
+void print_profile(FILE *out, unsigned long accesses) {
+    fprintf(out, "Profile (%s):\n", PROFILE_UNIT);
+    for (int p = 0; p < PROFILE_PHASES; p++) {
+        if (profile.calls[p] == 0) continue;
+        fprintf(out, "  %-20s %14lu total, %10lu calls, %8.1f per call, %8.1f per access\n", phase_names[p],
+                (unsigned long) profile.cycles[p], (unsigned long) profile.calls[p],
+                (double) profile.cycles[p] / profile.calls[p], accesses ? (double) profile.cycles[p] / accesses : 0.0);
+    }
+    fprintf(out, "  Inner tables allocated: %lu\n", (unsigned long) profile.inner_tables);
+    fprintf(out, "  Replacements: %lu, scan steps: %lu (%.2f per replacement, longest %lu)\n",
+            (unsigned long) profile.replacements, (unsigned long) profile.scan_steps,
+            profile.replacements ? (double) profile.scan_steps / profile.replacements : 0.0, (unsigned long) profile.longest_scan);
+    for (int i = 0; i < HARDWARE_COUNTERS; i++) {
+        if (hardware_fds[i] == -2) {
+            fprintf(out, "  %-20s %14lu\n", hardware_events[i].name, (unsigned long) hardware_values[i]);
+        } else {
+            fprintf(out, "  %-20s %14s\n", hardware_events[i].name, "unavailable");
+        }
+    }
+}
+
+#endif
@@ -0,0 +1,85 @@
+#ifndef PROFILE_H
+#define PROFILE_H
+
+// optional hot-path instrumentation, compiled in with `make PROFILE=1` (-DPROFILE). Without it every
+// macro below expands to nothing, so the normal build pays nothing for it
+
+#include <stdio.h>
+#include <stdint.h>
+
+typedef enum {
+    PHASE_PARSE, // decoding the trace into batches
+    PHASE_SPLIT, // splitting addresses into page table indices
+    PHASE_WALK, // page table walk / inverted hash lookup
+    PHASE_UPDATE, // hit or fault handling, including the replacement
+    PHASE_REPLACE, // choosing the victim
+    PHASE_LOG, // writing the debug log
+    PROFILE_PHASES
+} profilePhase;
+
+#ifdef PROFILE
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#define PROFILE_UNIT "cycles"
+static inline uint64_t profile_clock(void) {
+    return __rdtsc();
+}
+#else
+#include <time.h>
+#define PROFILE_UNIT "ns"
+static inline uint64_t profile_clock(void) {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (uint64_t) now.tv_sec * 1000000000ULL + now.tv_nsec;
+}
+#endif
+
+typedef struct {
+    uint64_t cycles[PROFILE_PHASES];
+    uint64_t calls[PROFILE_PHASES];
+    uint64_t inner_tables; // inner page tables allocated
+    uint64_t replacements;
+    uint64_t scan_steps; // frames examined by the replacement scans (clock hand steps)
+    uint64_t longest_scan;
+} profile_counters;
+
+// counters of the single-simulation mode; they are not synchronized, so sweeps are not profiled
+extern profile_counters profile;
+
+#define PROFILE_BEGIN(phase) uint64_t profile_begin_##phase = profile_clock()
+#define PROFILE_END(phase) do { \
+        profile.cycles[phase] += profile_clock() - profile_begin_##phase; \
+        profile.calls[phase]++; \
+    } while (0)
+#define PROFILE_COUNT(counter, n) (profile.counter += (n))
+#define PROFILE_SCAN(steps) do { \
+        uint64_t profile_steps = (steps); \
+        profile.replacements++; \
+        profile.scan_steps += profile_steps; \
+        if (profile_steps > profile.longest_scan) profile.longest_scan = profile_steps; \
+    } while (0)
+
+/* ============ FUNCTIONS ============ */
+
+void start_hardware_counters(void);
+
+void stop_hardware_counters(void);
+
+void print_profile(FILE *out, unsigned long accesses);
+
+/* =================================== */
+
+#else
+
+#define PROFILE_BEGIN(phase) do { } while (0)
+#define PROFILE_END(phase) do { } while (0)
+#define PROFILE_COUNT(counter, n) do { } while (0)
+#define PROFILE_SCAN(steps) do { } while (0)
+#define start_hardware_counters() do { } while (0)
+#define stop_hardware_counters() do { } while (0)
+#define print_profile(out, accesses) do { } while (0)
+
+#endif
+
+#endif
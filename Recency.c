@@ -0,0 +1,55 @@
+#include "Recency.h"
+
+// initialize an empty recency list able to hold frames 0 .. size-1
+recency_list* init_recency_list(size_t size) {
+    recency_list *list = (recency_list*) malloc(sizeof(recency_list));
+    list->prev = (int*) malloc(size * sizeof(int));
+    list->next = (int*) malloc(size * sizeof(int));
+    for (size_t i = 0; i < size; i++) {
+        list->prev[i] = RECENCY_UNLINKED;
+        list->next[i] = RECENCY_UNLINKED;
+    }
+    list->head = -1;
+    list->tail = -1;
+    list->size = size;
+    return list;
+}
+
+// unlinks a frame from the list; does nothing if it is not linked
+void recency_remove(recency_list *list, int index) {
+    if (list->prev[index] == RECENCY_UNLINKED) return;
+
+    if (list->prev[index] != -1) list->next[list->prev[index]] = list->next[index];
+    else list->head = list->next[index];
+
+    if (list->next[index] != -1) list->prev[list->next[index]] = list->prev[index];
+    else list->tail = list->prev[index];
+
+    list->prev[index] = RECENCY_UNLINKED;
+    list->next[index] = RECENCY_UNLINKED;
+}
+
+// marks a frame as the most recently used one, linking it if needed
+void recency_touch(recency_list *list, int index) {
+    if (list->tail == index) return;
+
+    recency_remove(list, index);
+    list->prev[index] = list->tail;
+    list->next[index] = -1;
+    if (list->tail != -1) list->next[list->tail] = index;
+    else list->head = index;
+    list->tail = index;
+}
+
+// returns the least recently used frame, or -1 if no frame is linked
+int recency_least_recent(recency_list *list) {
+    return list->head;
+}
+
+// free allocated memory to the recency list
+void free_recency_list(recency_list *list) {
+    if (list == NULL) return;
+    free(list->prev);
+    free(list->next);
+    free(list);
+}
@@ -0,0 +1,34 @@
+#ifndef RECENCY_H
+#define RECENCY_H
+
+#include <stdlib.h>
+#include <stdbool.h>
+
+#define RECENCY_UNLINKED -2
+
+// doubly linked list of frame indices ordered by recency: head is the least recently used
+// frame and tail is the most recently used one. Links are kept in arrays indexed by frame,
+// so moving a frame around never allocates
+typedef struct {
+    int *prev;
+    int *next;
+    int head; // least recently used frame (-1 if the list is empty)
+    int tail; // most recently used frame (-1 if the list is empty)
+    size_t size;
+} recency_list;
+
+/* ============ FUNCTIONS ============ */
+
+recency_list* init_recency_list(size_t size);
+
+void recency_touch(recency_list *list, int index);
+
+void recency_remove(recency_list *list, int index);
+
+int recency_least_recent(recency_list *list);
+
+void free_recency_list(recency_list *list);
+
+/* =================================== */
+
+#endif
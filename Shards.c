@@ -0,0 +1,143 @@
+#include "Shards.h"
+#include <string.h>
+
+// initialize the sampler; rate is the initial sampling rate (0, 1]. Only the sampled pages get a
+// last-access timestamp: at most max_samples + 1 of them with a budget, without one the hash grows
+// with the pages sampled
+shards* init_shards(double rate, size_t max_samples) {
+    shards *s = (shards*) calloc(1, sizeof(shards));
+    s->sd = init_hashed_stack_distance(max_samples + 1);
+    if (rate <= 0 || rate > 1) rate = 1;
+    s->threshold = rate * SHARDS_MODULUS;
+    if (s->threshold == 0) s->threshold = 1;
+    s->rate = (double) s->threshold / SHARDS_MODULUS;
+    s->max_samples = max_samples;
+    if (max_samples > 0) {
+        s->heap = (shards_sample*) malloc((max_samples + 1) * sizeof(shards_sample));
+    }
+    s->bin_width = 1;
+    return s;
+}
+
+// murmur3 finalizer: spreads consecutive page numbers uniformly over the hash space
+static uint32_t page_hash(uint32_t page) {
+    page ^= page >> 16;
+    page *= 0x85ebca6b;
+    page ^= page >> 13;
+    page *= 0xc2b2ae35;
+    page ^= page >> 16;
+    return page % SHARDS_MODULUS;
+}
+
+static void heap_push(shards *s, uint32_t hash, uint32_t page) {
+    size_t pos = s->heap_size++;
+    while (pos > 0 && s->heap[(pos - 1) / 2].hash < hash) {
+        s->heap[pos] = s->heap[(pos - 1) / 2];
+        pos = (pos - 1) / 2;
+    }
+    s->heap[pos].hash = hash;
+    s->heap[pos].page = page;
+}
+
+static shards_sample heap_pop(shards *s) {
+    shards_sample top = s->heap[0];
+    shards_sample last = s->heap[--s->heap_size];
+    size_t pos = 0;
+    while (2 * pos + 1 < s->heap_size) {
+        size_t child = 2 * pos + 1;
+        if (child + 1 < s->heap_size && s->heap[child + 1].hash > s->heap[child].hash) child++;
+        if (s->heap[child].hash <= last.hash) break;
+        s->heap[pos] = s->heap[child];
+        pos = child;
+    }
+    if (s->heap_size > 0) s->heap[pos] = last;
+    return top;
+}
+
+// doubles the bin width until the bin index fits, merging neighbouring bins
+static void add_to_histogram(shards *s, double distance, double weight) {
+    unsigned long scaled = distance < 1 ? 1 : (unsigned long) (distance + 0.5);
+    while ((scaled - 1) / s->bin_width >= SHARDS_BINS) {
+        for (int b = 0; b < SHARDS_BINS / 2; b++) {
+            s->histogram[b] = s->histogram[2 * b] + s->histogram[2 * b + 1];
+        }
+        memset(s->histogram + SHARDS_BINS / 2, 0, SHARDS_BINS / 2 * sizeof(double));
+        s->bin_width *= 2;
+    }
+    s->histogram[(scaled - 1) / s->bin_width] += weight;
+}
+
+// drops the pages with the highest hash until the sample set fits the budget again; the lower rate
+// applies from now on, so what was gathered so far is rescaled as if it had been sampled at that rate
+static void shrink_sample_set(shards *s) {
+    while (s->heap_size > s->max_samples) {
+        uint32_t new_threshold = s->heap[0].hash;
+        while (s->heap_size > 0 && s->heap[0].hash == new_threshold) {
+            stack_distance_remove(s->sd, heap_pop(s).page);
+        }
+
+        double new_rate = (double) new_threshold / SHARDS_MODULUS;
+        double factor = new_rate / s->rate;
+        for (int b = 0; b < SHARDS_BINS; b++) {
+            s->histogram[b] *= factor;
+        }
+        s->cold *= factor;
+        s->sampled *= factor;
+        s->threshold = new_threshold;
+        s->rate = new_rate;
+    }
+}
+
+// processes one reference to the page
+void shards_access(shards *s, uint32_t page) {
+    s->accesses++;
+    uint32_t hash = page_hash(page);
+    if (hash >= s->threshold) return;
+
+    s->sampled++;
+    unsigned long distance = stack_distance_access(s->sd, page);
+    if (distance == 0) {
+        s->cold++;
+        if (s->max_samples > 0) {
+            heap_push(s, hash, page);
+            shrink_sample_set(s);
+        }
+    } else {
+        // the other sampled pages in between stand for 1/rate pages each; the page itself is one
+        add_to_histogram(s, 1 + (distance - 1) / s->rate, 1);
+    }
+}
+
+// estimated LRU miss ratio for a memory with the given number of frames
+double shards_miss_ratio(shards *s, unsigned long frames) {
+    // the sample is corrected towards the expected number of sampled references at the current rate
+    // (SHARDS-adj): the difference goes to the first bin, the smallest distances. A negative difference
+    // (a hot page was sampled) takes references out of the first bins, down to none
+    double adjustment = s->accesses * s->rate - s->sampled;
+    double total = s->sampled + adjustment;
+    if (total <= 0) return 0;
+
+    double hits = adjustment;
+    for (unsigned long b = 0; b < SHARDS_BINS && (b + 1) * s->bin_width <= frames; b++) {
+        hits += s->histogram[b];
+    }
+    if (hits < 0) hits = 0;
+    return 1 - hits / total;
+}
+
+// largest memory size (in frames) the histogram has any information about
+unsigned long shards_max_frames(shards *s) {
+    unsigned long last = 0;
+    for (unsigned long b = 0; b < SHARDS_BINS; b++) {
+        if (s->histogram[b] > 0) last = b + 1;
+    }
+    return last * s->bin_width;
+}
+
+// free allocated memory to the sampler
+void free_shards(shards *s) {
+    if (s == NULL) return;
+    free_stack_distance(s->sd);
+    free(s->heap);
+    free(s);
+}
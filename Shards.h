@@ -0,0 +1,50 @@
+#ifndef SHARDS_H
+#define SHARDS_H
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include "StackDistance.h"
+
+#define SHARDS_MODULUS (1U << 24)
+#define SHARDS_BINS 1024
+
+// sampled page kept in the fixed-size sample set, ordered by hash in a max-heap
+typedef struct {
+    uint32_t hash;
+    uint32_t page;
+} shards_sample;
+
+// approximate LRU miss-ratio curve through spatial sampling (SHARDS): only references to pages whose
+// hash falls below a threshold are tracked, and their stack distances are scaled by 1/rate. With a
+// sample budget, the threshold is lowered whenever the sample set grows past it, so memory stays bounded
+typedef struct {
+    stack_distance *sd; // exact stack distances among the sampled pages (hashed by page)
+    uint32_t threshold; // pages with hash mod SHARDS_MODULUS below it are sampled
+    double rate; // threshold / SHARDS_MODULUS
+    size_t max_samples; // sample budget (0 keeps a fixed rate)
+    shards_sample *heap;
+    size_t heap_size;
+
+    double histogram[SHARDS_BINS]; // weighted references by scaled distance, bin b covers (b * bin_width, (b + 1) * bin_width]
+    unsigned long bin_width;
+    double cold; // weighted first references to sampled pages
+    double sampled; // weighted sampled references
+    unsigned long accesses;
+} shards;
+
+/* ============ FUNCTIONS ============ */
+
+shards* init_shards(double rate, size_t max_samples);
+
+void shards_access(shards *s, uint32_t page);
+
+double shards_miss_ratio(shards *s, unsigned long frames);
+
+unsigned long shards_max_frames(shards *s);
+
+void free_shards(shards *s);
+
+/* =================================== */
+
+#endif
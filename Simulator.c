@@ -0,0 +1,803 @@
+#include "Simulator.h"
+#include "utils.h"
+#include "Profile.h"
+
+static void dense_kernel(simulator *sim, const uint64_t *addresses, const char *operations, size_t count);
+static void two_level_kernel(simulator *sim, const uint64_t *addresses, const char *operations, size_t count);
+static void three_level_kernel(simulator *sim, const uint64_t *addresses, const char *operations, size_t count);
+static void inverted_kernel(simulator *sim, const uint64_t *addresses, const char *operations, size_t count);
+static void radix_kernel(simulator *sim, const uint64_t *addresses, const char *operations, size_t count);
+static void hashed_kernel(simulator *sim, const uint64_t *addresses, const char *operations, size_t count);
+static void trim_working_set(simulator *sim);
+
+// a new, empty page table of the simulation's type
+static page_table* new_page_table(simulator *sim) {
+    if (sim->table_type == FOUR_LEVEL || sim->table_type == FIVE_LEVEL) {
+        return init_radix_page_table(sim->table_type, sim->address_size - sim->offset);
+    }
+    unsigned int number_of_pages;
+    if (sim->table_type == INVERTED || sim->table_type == HASHED) {
+        number_of_pages = sim->total_physical_frames;
+    } else {
+        number_of_pages = 1U << sim->outer_table_offset;
+    }
+    return init_page_table(number_of_pages, sim->table_type);
+}
+
+// initialize a simulation: address split, page table, memory and replacement structures
+// (returns NULL if the algorithm is unknown, the frames don't fit in a page table entry or memory can't be allocated)
+simulator* init_simulator(const char *algorithm, unsigned int page_size, unsigned int mem_size, tableType table_type, debug_log *debug) {
+    replacement_function replace = get_replacement_function(algorithm);
+    if (!replace) return NULL;
+
+    simulator *sim = (simulator*) calloc(1, sizeof(simulator));
+    if (!sim) return NULL;
+    sim->replace = replace;
+    switch (table_type) {
+        case DENSE_PAGE_TABLE:
+            sim->kernel = dense_kernel;
+            break;
+        case TWO_LEVEL:
+            sim->kernel = two_level_kernel;
+            break;
+        case THREE_LEVEL:
+            sim->kernel = three_level_kernel;
+            break;
+        case INVERTED:
+            sim->kernel = inverted_kernel;
+            break;
+        case FOUR_LEVEL:
+        case FIVE_LEVEL:
+            sim->kernel = radix_kernel;
+            break;
+        case HASHED:
+            sim->kernel = hashed_kernel;
+            break;
+    }
+
+    sim->algorithm = algorithm;
+    sim->page_size = page_size;
+    sim->mem_size = mem_size;
+    sim->table_type = table_type;
+    sim->debug = debug;
+    sim->debug_mode = debug != NULL;
+
+    sim->offset = calculateOffset(page_size << 10);
+    sim->address_size = table_address_size(table_type);
+    sim->total_physical_frames = mem_size / page_size;
+    if (sim->total_physical_frames > PTE_MAX_FRAMES) {
+        free(sim);
+        return NULL;
+    }
+    set_tables_offset(table_type, sim->offset, &sim->outer_table_offset, &sim->second_inner_table_offset, &sim->third_inner_table_offset);
+
+    // initialize page table and memory
+    sim->page_table = new_page_table(sim);
+    sim->memory = init_memory(sim->total_physical_frames, &sim->free_frames);
+    sim->recency = init_recency_list(sim->total_physical_frames);
+    sim->frequency = init_frequency_table(sim->total_physical_frames);
+    sim->clock = init_clock_state(sim->total_physical_frames, get_algorithm_window(algorithm));
+    if (sim->memory && is_scan_replacement(replace) && !enable_frame_scan(sim->memory)) {
+        free_simulator(sim);
+        return NULL;
+    }
+    if (replace == opt_replacement) {
+        sim->future = init_future_heap(sim->total_physical_frames);
+    } else if (replace == adaptive_replacement) {
+        sim->adaptive = init_adaptive_cache(get_adaptive_policy(algorithm), sim->total_physical_frames);
+    }
+
+    // glibc's random() starts as if seeded with 1, so every instance replays the same sequence
+    initstate_r(1, sim->rng_state, sizeof(sim->rng_state), &sim->rng);
+
+    if (!sim->page_table || !sim->memory || !sim->free_frames || !sim->recency || !sim->frequency || !sim->clock) {
+        free_simulator(sim);
+        return NULL;
+    }
+
+    sim->context.mem_size = sim->total_physical_frames;
+    sim->context.rng = &sim->rng;
+    sim->context.clock = sim->clock;
+    sim->context.memory = sim->memory;
+    sim->context.future = sim->future;
+    sim->context.adaptive = sim->adaptive;
+    if (table_type == INVERTED) {
+        // entry i of the inverted table is the page table entry of frame i; the frame table links them
+        // while the frame holds a page, like with the other tables
+        inverted_page_table* table_ptr = (inverted_page_table*) sim->page_table->table;
+        sim->context.recency = table_ptr->recency;
+        sim->context.frequency = table_ptr->frequency;
+    } else {
+        sim->context.recency = sim->recency;
+        sim->context.frequency = sim->frequency;
+    }
+    return sim;
+}
+
+// records a debug event (debug mode only); the text is rendered later by the decoder
+static inline void log_event(simulator *sim, debugEvent type, uint32_t a, uint32_t b, uint32_t c, uint32_t d) {
+    PROFILE_BEGIN(PHASE_LOG);
+    debug_event(sim->debug, type, a, b, c, d);
+    PROFILE_END(PHASE_LOG);
+}
+
+// records the access; addresses wider than 32 bits (64 bit table types) are logged in two halves
+static inline void log_access(simulator *sim, uint64_t addr, char rw) {
+    if (sim->address_size > ADDRESS_SIZE) {
+        log_event(sim, DEBUG_ACCESS64, (uint32_t) addr, (uint32_t) (addr >> 32), rw, 0);
+    } else {
+        log_event(sim, DEBUG_ACCESS, (uint32_t) addr, rw, 0, 0);
+    }
+}
+
+// calls the replacement algorithm; pages wsclock wrote back while looking for the victim count as dirty
+static inline unsigned int select_victim(simulator *sim) {
+    PROFILE_BEGIN(PHASE_REPLACE);
+#ifdef PROFILE
+    unsigned long steps = sim->clock->steps;
+#endif
+    sim->context.now = sim->total_accesses;
+    unsigned int victim = sim->replace(&sim->context);
+    PROFILE_END(PHASE_REPLACE);
+    PROFILE_SCAN(sim->clock->steps - steps);
+    sim->dirty_pages += sim->clock->writebacks;
+    if (sim->frame_owner) {
+        for (unsigned long i = 0; i < sim->clock->writebacks; i++) {
+            sim->processes->list[sim->frame_owner[sim->clock->written[i]]].dirty_pages++;
+        }
+    }
+    sim->clock->writebacks = 0;
+    return victim;
+}
+
+// page number as the adaptive policies know it: pages of different processes must differ
+static inline uint64_t process_page(simulator *sim, uint64_t page) {
+    return page ^ ((uint64_t) sim->process << sim->process_shift);
+}
+
+// the access missed: it counts as a fault and the adaptive policies check whether the page is one of
+// their ghosts
+static inline void page_missed(simulator *sim, uint64_t page) {
+    sim->faults++;
+    if (sim->adaptive) adaptive_miss(sim->adaptive, process_page(sim, page));
+}
+
+// working set allocation: the page of the frame was referenced now, and the pages whose last
+// reference has left the window give their frames back
+static inline void working_set_referenced(simulator *sim, unsigned int frame) {
+    if (sim->allocation == NULL || sim->allocation->last_reference == NULL) return;
+    sim->allocation->last_reference[frame] = sim->total_accesses;
+    trim_working_set(sim);
+}
+
+// the page in the frame was referenced again: opt keys the frame by the position of the page's
+// next reference, the adaptive policies move it between their lists, the scan policies update the
+// frame table
+static inline void page_referenced(simulator *sim, unsigned int frame) {
+    working_set_referenced(sim, frame);
+    frame_accessed(sim->memory, frame);
+    if (sim->next_use) future_set(sim->future, frame, sim->next_use[sim->total_accesses - 1]);
+    if (sim->adaptive) adaptive_hit(sim->adaptive, frame);
+}
+
+// looks the page up in the TLB, if there is one; true means the page table walk was not needed
+static inline bool translate(simulator *sim, uint64_t page) {
+    return sim->tlb != NULL && tlb_lookup(sim->tlb, page);
+}
+
+// counts the memory references of the page table walk; on a TLB hit they are counted as avoided
+static inline void charge_walk(simulator *sim, bool translated, unsigned int references) {
+    sim->mem_access += references;
+    if (translated) {
+        sim->tlb_saved += references;
+    } else {
+        sim->walk_accesses += references;
+    }
+}
+
+// the walk missed the TLB: the translation goes into it
+static inline void translated_by_walk(simulator *sim, bool translated, uint64_t page, int frame) {
+    if (!translated && sim->tlb) tlb_fill(sim->tlb, page, frame);
+}
+
+// frames holding a page
+static inline unsigned int resident_pages(const simulator *sim) {
+    const free_frame_pool *pool = sim->table_type == INVERTED ? ((inverted_page_table*) sim->page_table->table)->free_entries : sim->free_frames;
+    return sim->total_physical_frames - pool->free_count;
+}
+
+// writes the window that just closed and starts the next one
+static void close_window(simulator *sim) {
+    metrics_stream *metrics = sim->metrics;
+    metrics_record record;
+    record.accesses = sim->total_accesses;
+    record.window_accesses = metrics->interval - metrics->remaining;
+    record.page_faults = sim->faults - metrics->faults;
+    record.dirty_pages = sim->dirty_pages - metrics->dirty_pages;
+    record.resident_pages = resident_pages(sim);
+    record.working_set = metrics->working_set;
+    write_metrics(metrics, &record);
+    metrics->remaining = metrics->interval;
+    metrics->faults = sim->faults;
+    metrics->dirty_pages = sim->dirty_pages;
+}
+
+// the access is done: its page enters the working set and every `interval` accesses a window closes
+static inline void track_metrics(simulator *sim, uint64_t page) {
+    metrics_reference(sim->metrics, process_page(sim, page));
+    if (--sim->metrics->remaining == 0) close_window(sim);
+}
+
+// the page in the frame is being evicted: with several processes, its owner loses the frame and is
+// charged the write back of a modified page
+static inline void page_evicted(simulator *sim, unsigned int frame, bool dirty) {
+    if (!sim->frame_owner) return;
+    process *owner = &sim->processes->list[sim->frame_owner[frame]];
+    owner->resident--;
+    if (dirty) owner->dirty_pages++;
+}
+
+// the page in the frame leaves memory and the frame goes back to the free pool (dynamic allocation):
+// a modified page is written back, every replacement structure forgets the frame and the TLB drops
+// its translation
+static void release_page(simulator *sim, unsigned int frame) {
+    if (sim->debug_mode) log_event(sim, DEBUG_RELEASE, frame, 0, 0, 0);
+    page_table_block *entry = sim->memory->entry[frame];
+    bool dirty = *entry & PTE_MODIFIED;
+    if (dirty) {
+        sim->dirty_pages++;
+        if (sim->debug_mode) log_event(sim, DEBUG_DIRTY, 0, 0, 0, 0);
+    }
+    page_evicted(sim, frame, dirty);
+
+    if (sim->table_type == INVERTED) {
+        inverted_page_table* table_ptr = (inverted_page_table*) sim->page_table->table;
+        inverted_table_remove(table_ptr, frame);
+        recency_remove(table_ptr->recency, frame);
+        frequency_remove(table_ptr->frequency, frame);
+        return_free_frame(table_ptr->free_entries, frame);
+        sim->memory->entry[frame] = NULL; // the clock hand and random pass over it until it is loaded again
+    } else {
+        release_frame(sim->memory, sim->free_frames, sim->recency, sim->frequency, frame);
+        if (sim->table_type == HASHED) { // hashed tables only keep the entries of resident pages
+            hashed_table_remove((hashed_page_table*) sim->page_table->table, entry);
+        }
+    }
+    if (sim->future) future_remove(sim->future, frame);
+    if (sim->tlb) tlb_invalidate_frame(sim->tlb, frame);
+
+    frame_allocation *allocation = sim->allocation;
+    allocation->releases++;
+    allocation_resized(allocation, resident_pages(sim), sim->total_accesses);
+    allocation_record(allocation, sim->total_accesses);
+}
+
+// frames are given back least recently used first while their last reference is τ accesses old or
+// more; each frame is released at most once per load, so this is O(1) amortized per access
+static void trim_working_set(simulator *sim) {
+    frame_allocation *allocation = sim->allocation;
+    recency_list *recency = sim->context.recency;
+    while (recency->head != -1 && allocation->last_reference[recency->head] + allocation->config.tau <= sim->total_accesses) {
+        release_page(sim, recency->head);
+    }
+}
+
+// a free frame may take the page: always with every frame available, only below the frames granted
+// by pff otherwise
+static inline bool frame_available(const simulator *sim) {
+    return sim->allocation == NULL || resident_pages(sim) < sim->allocation->limit;
+}
+
+// pff: the fault may grant a frame or take one back. A frame taken back while every frame granted is
+// in use is released right away, along with the page the replacement algorithm picks
+static inline void allocation_fault(simulator *sim) {
+    if (sim->allocation == NULL || sim->allocation->config.policy != ALLOCATION_PFF) return;
+    if (pff_fault(sim->allocation, sim->total_accesses) == -1 && resident_pages(sim) > sim->allocation->limit) {
+        release_page(sim, select_victim(sim));
+    }
+}
+
+// the page was just brought into the frame: the clock algorithms see it as referenced and in use,
+// the TLB drops the translation of the page evicted from it and the scan policies restart its use count
+static inline void page_loaded(simulator *sim, unsigned int frame, uint64_t page) {
+    frame_loaded(sim->memory, frame);
+    sim->clock->last_use[frame] = sim->total_accesses;
+    if (sim->tlb) tlb_invalidate_frame(sim->tlb, frame);
+    if (sim->next_use) future_set(sim->future, frame, sim->next_use[sim->total_accesses - 1]);
+    if (sim->adaptive) adaptive_load(sim->adaptive, frame, process_page(sim, page));
+    if (sim->frame_owner) {
+        process *owner = &sim->processes->list[sim->process];
+        sim->frame_owner[frame] = sim->process;
+        if (++owner->resident > owner->peak_resident) owner->peak_resident = owner->resident;
+    }
+    if (sim->allocation) {
+        allocation_resized(sim->allocation, resident_pages(sim), sim->total_accesses);
+        allocation_record(sim->allocation, sim->total_accesses);
+        working_set_referenced(sim, frame);
+    }
+}
+
+// handles an access to a page of an inverted page table; returns the entry (and frame) holding the page
+static inline int access_inverted(simulator *sim, int32_t outer_page_addr, char rw) {
+    inverted_page_table* table_ptr = (inverted_page_table*) sim->page_table->table; // instantiate the table to its correct type
+    page_table_block modified = rw == 'W' ? PTE_MODIFIED : 0;
+
+    if (sim->debug_mode) log_event(sim, DEBUG_INVERTED_LOOKUP, outer_page_addr, 0, 0, 0);
+
+    // looks the page up through the hash anchor table; on a miss, takes the lowest free entry
+    PROFILE_BEGIN(PHASE_WALK);
+    int found_index = inverted_table_lookup(table_ptr, outer_page_addr, sim->process);
+    PROFILE_END(PHASE_WALK);
+    if (found_index != -1) { // page is in memory
+        if (sim->debug_mode) {
+            log_event(sim, DEBUG_INVERTED_FOUND, found_index, 0, 0, 0);
+            log_event(sim, DEBUG_INVERTED_HIT, 0, 0, 0, 0);
+        }
+
+        // Hit: update access order, reference & modified bits and access counter
+        table_ptr->data[found_index] |= PTE_REFERENCED | modified;
+        recency_touch(table_ptr->recency, found_index);
+        frequency_increment(table_ptr->frequency, found_index);
+        page_referenced(sim, found_index);
+        return found_index;
+    }
+
+    allocation_fault(sim);
+    int free_block_index = frame_available(sim) ? take_free_frame(table_ptr->free_entries) : -1;
+    if (free_block_index != -1) { // page was not found but there is a free block
+        if (sim->debug_mode) log_event(sim, DEBUG_INVERTED_FREE_ENTRY, free_block_index, 0, 0, 0);
+        sim->page_faults++;
+        sim->mem_access++;
+        page_missed(sim, outer_page_addr);
+
+        if (sim->debug_mode) log_event(sim, DEBUG_INVERTED_FAULT_FREE, outer_page_addr, free_block_index, 0, 0);
+
+        // associate the page to the block
+        sim->memory->entry[free_block_index] = &table_ptr->data[free_block_index];
+        inverted_table_insert(table_ptr, free_block_index, outer_page_addr, sim->process);
+        table_ptr->data[free_block_index] = make_pte(free_block_index, rw == 'W');
+        page_loaded(sim, free_block_index, outer_page_addr);
+        recency_touch(table_ptr->recency, free_block_index);
+        frequency_reset(table_ptr->frequency, free_block_index);
+        return free_block_index;
+    }
+
+    // page was not found and there is not a free block
+    if (sim->debug_mode) log_event(sim, DEBUG_INVERTED_REPLACE, 0, 0, 0, 0);
+    page_missed(sim, outer_page_addr);
+
+    // call replacement algorithm
+    int index_to_replace = select_victim(sim);
+
+    if (sim->debug_mode) log_event(sim, DEBUG_VICTIM, index_to_replace, 0, 0, 0);
+
+    bool dirty = table_ptr->data[index_to_replace] & PTE_MODIFIED;
+    if (dirty) { // page was modified and need to be written on the disk
+        sim->dirty_pages++;
+        if (sim->debug_mode) log_event(sim, DEBUG_DIRTY, 0, 0, 0, 0);
+    }
+    page_evicted(sim, index_to_replace, dirty);
+    // replace the page
+    inverted_table_remove(table_ptr, index_to_replace);
+    inverted_table_insert(table_ptr, index_to_replace, outer_page_addr, sim->process);
+    table_ptr->data[index_to_replace] = make_pte(index_to_replace, rw == 'W');
+    page_loaded(sim, index_to_replace, outer_page_addr);
+    recency_touch(table_ptr->recency, index_to_replace);
+    frequency_reset(table_ptr->frequency, index_to_replace);
+
+    sim->mem_access++;
+    return index_to_replace;
+}
+
+// handles an access to the page table entry of a dense, hierarchical or hashed page table
+static inline void access_page(simulator *sim, page_table_block *block, char rw, uint64_t page,
+                               int32_t outer_page_addr, int32_t second_inner_page_addr, int32_t third_inner_page_addr) {
+
+    if (!(*block & PTE_VALID)) { // page was not yet brought to memory
+        sim->page_faults++;
+        sim->mem_access++;
+        page_missed(sim, page);
+
+        if (sim->debug_mode) {
+            if (sim->address_size > ADDRESS_SIZE) {
+                log_event(sim, DEBUG_FAULT64, (uint32_t) page, (uint32_t) (page >> 32), 0, 0);
+            } else {
+                log_event(sim, DEBUG_FAULT, outer_page_addr, second_inner_page_addr, third_inner_page_addr, 0);
+            }
+        }
+
+        allocation_fault(sim);
+        unsigned int frame;
+        int ff_index = frame_available(sim) ? find_free_frame(sim->free_frames) : -1;
+        if (ff_index == -1) { // there is not a single free memory frame
+
+            if (sim->debug_mode) log_event(sim, DEBUG_MEMORY_FULL, 0, 0, 0, 0);
+
+            // call page replacement algorithm
+            frame = select_victim(sim);
+
+            if (sim->debug_mode) log_event(sim, DEBUG_VICTIM, frame, 0, 0, 0);
+
+            page_table_block *victim = sim->memory->entry[frame];
+            bool dirty = *victim & PTE_MODIFIED;
+            if (dirty) { // page was modified and need to be written on the disk
+                sim->dirty_pages++;
+                if (sim->debug_mode) log_event(sim, DEBUG_DIRTY, 0, 0, 0, 0);
+            }
+            page_evicted(sim, frame, dirty);
+
+            *victim = 0; // make the old page allocated invalid
+            if (sim->table_type == HASHED) { // hashed tables only keep the entries of resident pages
+                hashed_table_remove((hashed_page_table*) sim->page_table->table, victim);
+            }
+        } else {
+            sim->mem_access++;
+            if (sim->debug_mode) log_event(sim, DEBUG_FREE_FRAME, ff_index, 0, 0, 0);
+            frame = ff_index;
+        }
+
+        // the block is brought into the frame
+        sim->memory->entry[frame] = block;
+        *block = make_pte(frame, rw == 'W');
+        recency_touch(sim->recency, frame);
+        frequency_reset(sim->frequency, frame);
+        page_loaded(sim, frame, page);
+    } else {
+        unsigned int frame = pte_frame(*block);
+        if (sim->debug_mode) {
+            if (sim->address_size > ADDRESS_SIZE) {
+                log_event(sim, DEBUG_HIT64, (uint32_t) page, (uint32_t) (page >> 32), frame, 0);
+            } else {
+                log_event(sim, DEBUG_HIT, outer_page_addr, second_inner_page_addr, sim->third_inner_table_offset, frame);
+            }
+        }
+
+        // hit: update access order, reference & modified bits and number of accesses
+        recency_touch(sim->recency, frame);
+        frequency_increment(sim->frequency, frame);
+        page_referenced(sim, frame);
+        *block |= PTE_REFERENCED | (rw == 'W' ? PTE_MODIFIED : 0);
+    }
+}
+
+/* ============ KERNELS ============ */
+
+// one simulation loop per table type, chosen once in init_simulator: the address split and the
+// page table walk of each type are written out, so the loop has no type dispatch left
+
+static void dense_kernel(simulator *sim, const uint64_t *addresses, const char *operations, size_t count) {
+    dense_page_table *table = (dense_page_table*) sim->page_table->table;
+    for (size_t i = 0; i < count; i++) {
+        sim->total_accesses++;
+        if (sim->debug_mode) log_access(sim, addresses[i], operations[i]);
+        PROFILE_BEGIN(PHASE_SPLIT);
+        int32_t outer_page_addr = page_number((uint32_t) addresses[i], sim->offset);
+        PROFILE_END(PHASE_SPLIT);
+        bool translated = translate(sim, outer_page_addr);
+        charge_walk(sim, translated, 1);
+        PROFILE_BEGIN(PHASE_UPDATE);
+        access_page(sim, &table->data[outer_page_addr], operations[i], outer_page_addr, outer_page_addr, -1, -1);
+        PROFILE_END(PHASE_UPDATE);
+        translated_by_walk(sim, translated, outer_page_addr, pte_frame(table->data[outer_page_addr]));
+        if (sim->metrics) track_metrics(sim, outer_page_addr);
+    }
+}
+
+static void two_level_kernel(simulator *sim, const uint64_t *addresses, const char *operations, size_t count) {
+    uint32_t second_mask = make_mask(sim->second_inner_table_offset);
+    uint32_t outer_mask = make_mask(sim->outer_table_offset);
+    for (size_t i = 0; i < count; i++) {
+        sim->total_accesses++;
+        if (sim->debug_mode) log_access(sim, addresses[i], operations[i]);
+        PROFILE_BEGIN(PHASE_SPLIT);
+        uint32_t address = (uint32_t) addresses[i]; // 32 bit address space: higher bits are dropped
+        int32_t second_inner_page_addr = (address >> sim->offset) & second_mask;
+        int32_t outer_page_addr = (address >> (sim->offset + sim->second_inner_table_offset)) & outer_mask;
+        uint32_t page = page_number((uint32_t) addresses[i], sim->offset);
+        PROFILE_END(PHASE_SPLIT);
+        bool translated = translate(sim, page);
+        PROFILE_BEGIN(PHASE_WALK);
+        page_table_block *block;
+        unsigned int references = 2;
+        if (sim->walk_cache && !translated) {
+            block = cached_walk_two_level(sim->walk_cache, sim->page_table, outer_page_addr, second_inner_page_addr, &references);
+        } else {
+            block = get_page_two_level(sim->page_table, outer_page_addr, second_inner_page_addr, sim->second_inner_table_offset);
+        }
+        PROFILE_END(PHASE_WALK);
+        charge_walk(sim, translated, references);
+        PROFILE_BEGIN(PHASE_UPDATE);
+        access_page(sim, block, operations[i], page, outer_page_addr, second_inner_page_addr, -1);
+        PROFILE_END(PHASE_UPDATE);
+        translated_by_walk(sim, translated, page, pte_frame(*block));
+        if (sim->metrics) track_metrics(sim, page);
+    }
+}
+
+static void three_level_kernel(simulator *sim, const uint64_t *addresses, const char *operations, size_t count) {
+    uint32_t third_mask = make_mask(sim->third_inner_table_offset);
+    uint32_t second_mask = make_mask(sim->second_inner_table_offset);
+    uint32_t outer_mask = make_mask(sim->outer_table_offset);
+    for (size_t i = 0; i < count; i++) {
+        sim->total_accesses++;
+        if (sim->debug_mode) log_access(sim, addresses[i], operations[i]);
+        PROFILE_BEGIN(PHASE_SPLIT);
+        uint32_t address = (uint32_t) addresses[i]; // 32 bit address space: higher bits are dropped
+        int32_t third_inner_page_addr = (address >> sim->offset) & third_mask;
+        int32_t second_inner_page_addr = (address >> (sim->offset + sim->third_inner_table_offset)) & second_mask;
+        int32_t outer_page_addr = (address >> (sim->offset + sim->second_inner_table_offset + sim->third_inner_table_offset)) & outer_mask;
+        uint32_t page = page_number((uint32_t) addresses[i], sim->offset);
+        PROFILE_END(PHASE_SPLIT);
+        bool translated = translate(sim, page);
+        PROFILE_BEGIN(PHASE_WALK);
+        page_table_block *block;
+        unsigned int references = 3;
+        if (sim->walk_cache && !translated) {
+            block = cached_walk_three_level(sim->walk_cache, sim->page_table, outer_page_addr, second_inner_page_addr, third_inner_page_addr, &references);
+        } else {
+            block = get_page_three_level(sim->page_table, outer_page_addr, second_inner_page_addr, third_inner_page_addr,
+                                         sim->second_inner_table_offset, sim->third_inner_table_offset);
+        }
+        PROFILE_END(PHASE_WALK);
+        charge_walk(sim, translated, references);
+        PROFILE_BEGIN(PHASE_UPDATE);
+        access_page(sim, block, operations[i], page, outer_page_addr, second_inner_page_addr, third_inner_page_addr);
+        PROFILE_END(PHASE_UPDATE);
+        translated_by_walk(sim, translated, page, pte_frame(*block));
+        if (sim->metrics) track_metrics(sim, page);
+    }
+}
+
+static void inverted_kernel(simulator *sim, const uint64_t *addresses, const char *operations, size_t count) {
+    for (size_t i = 0; i < count; i++) {
+        sim->total_accesses++;
+        if (sim->debug_mode) log_access(sim, addresses[i], operations[i]);
+        uint32_t page = page_number((uint32_t) addresses[i], sim->offset);
+        bool translated = translate(sim, page);
+        charge_walk(sim, translated, 1);
+        PROFILE_BEGIN(PHASE_UPDATE);
+        int frame = access_inverted(sim, page, operations[i]);
+        PROFILE_END(PHASE_UPDATE);
+        translated_by_walk(sim, translated, page, frame);
+        if (sim->metrics) track_metrics(sim, page);
+    }
+}
+
+// four and five level tables: one memory reference per level of the walk
+static void radix_kernel(simulator *sim, const uint64_t *addresses, const char *operations, size_t count) {
+    unsigned int levels = ((radix_page_table*) sim->page_table->table)->levels;
+    for (size_t i = 0; i < count; i++) {
+        sim->total_accesses++;
+        if (sim->debug_mode) log_access(sim, addresses[i], operations[i]);
+        PROFILE_BEGIN(PHASE_SPLIT);
+        uint64_t page = virtual_page(addresses[i], sim->offset, sim->address_size);
+        PROFILE_END(PHASE_SPLIT);
+        bool translated = translate(sim, page);
+        PROFILE_BEGIN(PHASE_WALK);
+        page_table_block *block = get_page_radix(sim->page_table, page);
+        PROFILE_END(PHASE_WALK);
+        charge_walk(sim, translated, levels);
+        PROFILE_BEGIN(PHASE_UPDATE);
+        access_page(sim, block, operations[i], page, -1, -1, -1);
+        PROFILE_END(PHASE_UPDATE);
+        translated_by_walk(sim, translated, page, pte_frame(*block));
+        if (sim->metrics) track_metrics(sim, page);
+    }
+}
+
+// hashed tables: the bucket is one memory reference, each chain entry compared is another
+static void hashed_kernel(simulator *sim, const uint64_t *addresses, const char *operations, size_t count) {
+    for (size_t i = 0; i < count; i++) {
+        sim->total_accesses++;
+        if (sim->debug_mode) log_access(sim, addresses[i], operations[i]);
+        PROFILE_BEGIN(PHASE_SPLIT);
+        uint64_t page = virtual_page(addresses[i], sim->offset, sim->address_size);
+        PROFILE_END(PHASE_SPLIT);
+        bool translated = translate(sim, page);
+        PROFILE_BEGIN(PHASE_WALK);
+        unsigned int probes;
+        page_table_block *block = get_page_hashed(sim->page_table, page, sim->process, &probes);
+        PROFILE_END(PHASE_WALK);
+        charge_walk(sim, translated, 1 + probes);
+        PROFILE_BEGIN(PHASE_UPDATE);
+        access_page(sim, block, operations[i], page, -1, -1, -1);
+        PROFILE_END(PHASE_UPDATE);
+        translated_by_walk(sim, translated, page, pte_frame(*block));
+        if (sim->metrics) track_metrics(sim, page);
+    }
+}
+
+/* ================================= */
+
+// simulates a batch of memory accesses
+void simulate_batch(simulator *sim, const uint64_t *addresses, const char *operations, size_t count) {
+    sim->kernel(sim, addresses, operations, count);
+    if (sim->adaptive) adaptive_record(sim->adaptive, sim->total_accesses);
+}
+
+// gets the simulation ready for a trace of several processes sharing the frames (global replacement).
+// A text trace may show its first pid only after some batches were simulated: those accesses were of
+// process 0, which is created with their counters and owns every frame in use. Returns false if memory
+// can't be allocated
+bool enable_processes(simulator *sim) {
+    if (sim->processes) return true;
+    sim->processes = init_process_table();
+    sim->frame_owner = (uint32_t*) calloc(sim->total_physical_frames, sizeof(uint32_t));
+    if (sim->replace == wsclock_replacement) {
+        sim->clock->written = (unsigned int*) malloc(sim->total_physical_frames * sizeof(unsigned int));
+    }
+    sim->process_shift = sim->address_size - sim->offset;
+    if (!sim->processes || !sim->frame_owner || (sim->replace == wsclock_replacement && !sim->clock->written)) return false;
+
+    if (sim->total_accesses > 0) {
+        int index = add_process(sim->processes, 0);
+        if (index == -1) return false;
+        process *first = &sim->processes->list[index];
+        if (sim->table_type != INVERTED && sim->table_type != HASHED) first->page_table = sim->page_table;
+        first->accesses = sim->total_accesses;
+        first->page_faults = sim->faults;
+        first->dirty_pages = sim->dirty_pages;
+        first->resident = resident_pages(sim);
+        first->peak_resident = first->resident;
+    }
+    return true;
+}
+
+// makes the process the running one, creating it on its first access. Dense, hierarchical and radix
+// tables are per process (the first process takes the one init_simulator made); inverted and hashed
+// tables are shared and tell the processes apart by their address space. The TLB switches context and
+// the page walk cache, whose entries point into the previous table, is flushed. Returns false if the
+// process can't be created
+static bool switch_process(simulator *sim, uint32_t pid) {
+    process_table *processes = sim->processes;
+    int index = find_process(processes, pid);
+    bool created = index == -1;
+    if (created) {
+        index = add_process(processes, pid);
+        if (index == -1) return false;
+        if (sim->table_type != INVERTED && sim->table_type != HASHED) {
+            processes->list[index].page_table = index == 0 ? sim->page_table : new_page_table(sim);
+            if (!processes->list[index].page_table) return false;
+        }
+    }
+    if (!created && (uint32_t) index == sim->process) return true;
+
+    if (sim->debug_mode) log_event(sim, DEBUG_SWITCH, pid, index, 0, 0);
+    if ((uint32_t) index == sim->process) return true; // the first process
+    sim->process = index;
+    if (processes->list[index].page_table) sim->page_table = processes->list[index].page_table;
+    if (sim->tlb) tlb_switch_context(sim->tlb, index);
+    if (sim->walk_cache) flush_walk_cache(sim->walk_cache);
+    return true;
+}
+
+// simulates a batch of accesses of several processes (see enable_processes): each run of accesses of
+// one process goes through the kernel at once. Returns false if a process can't be created
+bool simulate_processes(simulator *sim, const uint64_t *addresses, const char *operations, const uint32_t *pids, size_t count) {
+    size_t start = 0;
+    while (start < count) {
+        size_t end = start + 1;
+        while (end < count && pids[end] == pids[start]) end++;
+        if (!switch_process(sim, pids[start])) return false;
+
+        process *running = &sim->processes->list[sim->process];
+        unsigned long faults = sim->faults;
+        sim->kernel(sim, addresses + start, operations + start, end - start);
+        running->accesses += end - start;
+        running->page_faults += sim->faults - faults;
+        start = end;
+    }
+    if (sim->adaptive) adaptive_record(sim->adaptive, sim->total_accesses);
+    return true;
+}
+
+// memory used by the page tables of the simulation: the one table, or the tables of every process
+void get_simulator_page_table_usage(const simulator *sim, page_table_usage *usage) {
+    get_page_table_usage(sim->page_table, usage);
+    if (!sim->processes) return;
+    for (size_t i = 0; i < sim->processes->count; i++) {
+        page_table *table = sim->processes->list[i].page_table;
+        if (table == NULL || table == sim->page_table) continue;
+        page_table_usage process_usage;
+        get_page_table_usage(table, &process_usage);
+        usage->nodes += process_usage.nodes;
+        usage->allocations += process_usage.allocations;
+        usage->bytes += process_usage.bytes;
+    }
+}
+
+// gives opt the next-use positions of the whole trace (see compute_next_use); they are indexed by
+// the position of the access in the trace, so the simulation must start at the first access
+void set_next_use(simulator *sim, const size_t *next_use) {
+    sim->next_use = next_use;
+}
+
+// streams windowed metrics of the simulation (see Metrics.h); the stream is counted from the accesses
+// simulated from now on
+void set_metrics(simulator *sim, metrics_stream *metrics) {
+    sim->metrics = metrics;
+    if (metrics) {
+        metrics->faults = sim->faults;
+        metrics->dirty_pages = sim->dirty_pages;
+    }
+}
+
+// writes the last window if the run ended in the middle of one
+void finish_metrics(simulator *sim) {
+    if (sim->metrics && sim->metrics->remaining != sim->metrics->interval) close_window(sim);
+}
+
+// puts a TLB in front of the page table; returns false if it can't be allocated. The TLB only changes
+// the accounting (adjusted_memory_accesses), the simulation itself is the same
+bool enable_tlb(simulator *sim, const tlb_config *config) {
+    free_tlb(sim->tlb);
+    sim->tlb = init_tlb(config, sim->total_physical_frames);
+    return sim->tlb != NULL;
+}
+
+// caches upper level page table entries of two and three level tables: hits skip levels of the walk,
+// both in the memory references counted and in the pointers followed. Returns false for other table
+// types or if the cache can't be allocated
+bool enable_walk_cache(simulator *sim, size_t entries) {
+    free_walk_cache(sim->walk_cache);
+    sim->walk_cache = init_walk_cache(sim->table_type, entries, sim->second_inner_table_offset, sim->third_inner_table_offset);
+    return sim->walk_cache != NULL;
+}
+
+// lets the number of frames follow the simulation (see Allocation.h), with the memory size as the
+// physical limit; it must be called before the first access. Returns false for the policies whose
+// victim search can't pass over free frames (the scan policies, arc, 2q and lirs) or if memory can't
+// be allocated
+bool enable_dynamic_allocation(simulator *sim, const allocation_config *config) {
+    if (is_scan_replacement(sim->replace) || sim->replace == adaptive_replacement) return false;
+    free_frame_allocation(sim->allocation);
+    sim->allocation = init_frame_allocation(config, sim->total_physical_frames);
+    return sim->allocation != NULL;
+}
+
+// memory accesses once the page table walks avoided by TLB hits are taken out
+unsigned long adjusted_memory_accesses(const simulator *sim) {
+    return (unsigned long) sim->mem_access - sim->tlb_saved;
+}
+
+// average time of an access in nanoseconds: the TLB lookup (if there is a TLB), the page table
+// references that were not avoided, the data access itself, and the disk for page faults and
+// write backs of dirty pages
+double effective_access_time(const simulator *sim, const access_latency *latency) {
+    if (sim->total_accesses == 0) return 0.0;
+    double accesses = sim->total_accesses;
+    double time = latency->memory * (1.0 + sim->walk_accesses / accesses);
+    if (sim->tlb) time += latency->tlb;
+    time += latency->disk * ((double) sim->faults + sim->dirty_pages) / accesses;
+    return time;
+}
+
+// simulates one memory access
+void simulate_access(simulator *sim, uint64_t addr, char rw) {
+    sim->kernel(sim, &addr, &rw, 1);
+}
+
+// free allocated memory to the simulation
+void free_simulator(simulator *sim) {
+    if (sim == NULL) return;
+    if (sim->processes) {
+        for (size_t i = 0; i < sim->processes->count; i++) {
+            page_table *table = sim->processes->list[i].page_table;
+            if (table && table != sim->page_table) free_page_table(table, sim->table_type);
+        }
+        free_process_table(sim->processes);
+    }
+    free(sim->frame_owner);
+    if (sim->page_table) free_page_table(sim->page_table, sim->table_type);
+    free_memory(sim->memory);
+    free_free_frame_pool(sim->free_frames);
+    free_recency_list(sim->recency);
+    free_frequency_table(sim->frequency);
+    free_clock_state(sim->clock);
+    free_future_heap(sim->future);
+    free_adaptive_cache(sim->adaptive);
+    free_tlb(sim->tlb);
+    free_walk_cache(sim->walk_cache);
+    free_frame_allocation(sim->allocation);
+    free(sim);
+}
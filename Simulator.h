@@ -0,0 +1,123 @@
+#ifndef SIMULATOR_H
+#define SIMULATOR_H
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include "Memory.h"
+#include "PageTable.h"
+#include "DebugLog.h"
+#include "Tlb.h"
+#include "WalkCache.h"
+#include "Process.h"
+#include "Metrics.h"
+#include "Allocation.h"
+
+#define RANDOM_STATE_SIZE 128
+
+typedef struct simulator simulator;
+
+// latencies of the effective access time model, in nanoseconds
+typedef struct {
+    double memory;
+    double tlb;
+    double disk; // page fault service and write back of a dirty page
+} access_latency;
+
+// simulation loop specialized for one table type
+typedef void (*simulation_kernel)(simulator *sim, const uint64_t *addresses, const char *operations, size_t count);
+
+// one independent simulation: its configuration, page table, memory and counters. Nothing is shared
+// between instances, so several of them can run side by side on different threads
+struct simulator {
+    // configuration
+    const char *algorithm;
+    unsigned int page_size;
+    unsigned int mem_size;
+    tableType table_type;
+    simulation_kernel kernel; // resolved once from table_type
+    replacement_function replace; // resolved once from algorithm
+
+    // address split
+    uint32_t offset;
+    uint32_t address_size; // bits of the virtual addresses (see table_address_size)
+    uint32_t outer_table_offset;
+    uint32_t second_inner_table_offset;
+    uint32_t third_inner_table_offset;
+    unsigned int total_physical_frames;
+
+    // state
+    page_table *page_table;
+    frame_table *memory;
+    free_frame_pool *free_frames;
+    recency_list *recency; // frames in access order, used in lru
+    frequency_table *frequency; // frames grouped by access count, used in lfu and mfu
+    struct random_data rng; // random replacement state (same sequence as the unseeded random())
+    char rng_state[RANDOM_STATE_SIZE];
+    clock_state *clock; // hand of clock, second_chance and wsclock
+    replacement_context context; // what the replacement algorithm sees (inverted tables use their own structures)
+    future_heap *future; // opt only: frames keyed by the next use of their pages
+    const size_t *next_use; // opt only: next reference of each trace position (owned by the caller)
+    adaptive_cache *adaptive; // arc, 2q and lirs only
+    tlb *tlb; // optional TLB in front of the page table (see enable_tlb)
+    walk_cache *walk_cache; // optional page walk cache of hierarchical tables (see enable_walk_cache)
+
+    // processes of a multi-process trace under global replacement (see enable_processes): page_table is
+    // the table of the running process, all of them share the frames
+    process_table *processes; // NULL in single-process runs
+    uint32_t process; // index of the running process, which is also its address space identifier (0 otherwise)
+    uint32_t process_shift; // the adaptive policies see the process folded into the page number above this bit
+    uint32_t *frame_owner; // process whose page is in each frame
+
+    metrics_stream *metrics; // optional windowed time series (see set_metrics), owned by the caller
+    frame_allocation *allocation; // optional dynamic allocation (see enable_dynamic_allocation); NULL: every frame
+
+    // results
+    unsigned long total_accesses;
+    int mem_access;
+    unsigned int page_faults;
+    unsigned int dirty_pages;
+    unsigned long faults; // every page fault; page_faults leaves out the replacements of inverted tables
+    unsigned long walk_accesses; // page table references actually made (after the TLB and the page walk cache)
+    unsigned long tlb_saved; // page table references avoided by TLB hits
+
+    bool debug_mode;
+    debug_log *debug; // binary event log, written by its own thread
+};
+
+/* ============ FUNCTIONS ============ */
+
+simulator* init_simulator(const char *algorithm, unsigned int page_size, unsigned int mem_size, tableType table_type, debug_log *debug);
+
+void simulate_access(simulator *sim, uint64_t addr, char rw);
+
+void simulate_batch(simulator *sim, const uint64_t *addresses, const char *operations, size_t count);
+
+bool enable_processes(simulator *sim);
+
+bool simulate_processes(simulator *sim, const uint64_t *addresses, const char *operations, const uint32_t *pids, size_t count);
+
+void get_simulator_page_table_usage(const simulator *sim, page_table_usage *usage);
+
+void set_next_use(simulator *sim, const size_t *next_use);
+
+void set_metrics(simulator *sim, metrics_stream *metrics);
+
+void finish_metrics(simulator *sim);
+
+bool enable_tlb(simulator *sim, const tlb_config *config);
+
+bool enable_walk_cache(simulator *sim, size_t entries);
+
+bool enable_dynamic_allocation(simulator *sim, const allocation_config *config);
+
+unsigned long adjusted_memory_accesses(const simulator *sim);
+
+double effective_access_time(const simulator *sim, const access_latency *latency);
+
+void free_simulator(simulator *sim);
+
+/* =================================== */
+
+#endif
@@ -0,0 +1,231 @@
+#include "StackDistance.h"
+#include <string.h>
+
+#define INITIAL_CAPACITY 1024
+
+// initialize the analysis for pages 0 .. number_of_pages-1
+stack_distance* init_stack_distance(size_t number_of_pages) {
+    stack_distance *sd = (stack_distance*) calloc(1, sizeof(stack_distance));
+    sd->number_of_pages = number_of_pages;
+    sd->last_access = (int*) calloc(number_of_pages, sizeof(int));
+    sd->capacity = INITIAL_CAPACITY;
+    sd->owner = (uint32_t*) malloc((sd->capacity + 1) * sizeof(uint32_t));
+    sd->tree = (int*) calloc(sd->capacity + 1, sizeof(int));
+    sd->histogram_size = INITIAL_CAPACITY;
+    sd->histogram = (unsigned long*) calloc(sd->histogram_size, sizeof(unsigned long));
+    return sd;
+}
+
+static void allocate_slots(stack_distance *sd, unsigned int slot_bits) {
+    sd->slot_bits = slot_bits;
+    sd->slots = (size_t) 1 << slot_bits;
+    sd->keys = (uint32_t*) malloc(sd->slots * sizeof(uint32_t));
+    sd->times = (int*) calloc(sd->slots, sizeof(int));
+}
+
+// initialize the analysis keeping the timestamps in a hash sized for about expected_pages distinct
+// pages (it grows past them), so memory follows the pages seen instead of the whole address space
+stack_distance* init_hashed_stack_distance(size_t expected_pages) {
+    stack_distance *sd = (stack_distance*) calloc(1, sizeof(stack_distance));
+    unsigned int slot_bits = 4;
+    while (((size_t) 1 << slot_bits) < 2 * expected_pages) slot_bits++;
+    allocate_slots(sd, slot_bits);
+    sd->capacity = INITIAL_CAPACITY;
+    sd->owner = (uint32_t*) malloc((sd->capacity + 1) * sizeof(uint32_t));
+    sd->tree = (int*) calloc(sd->capacity + 1, sizeof(int));
+    sd->histogram_size = INITIAL_CAPACITY;
+    sd->histogram = (unsigned long*) calloc(sd->histogram_size, sizeof(unsigned long));
+    return sd;
+}
+
+// first slot probed for the page (fibonacci hashing: the pages sampled by shards are those with the
+// lowest murmur hashes, so the slot comes from a different function)
+static size_t home_slot(const stack_distance *sd, uint32_t page) {
+    return (size_t) (((uint64_t) page * 0x9e3779b97f4a7c15ULL) >> (64 - sd->slot_bits));
+}
+
+// slot of the page in the hash, or the empty slot where it would go
+static size_t find_slot(const stack_distance *sd, uint32_t page) {
+    size_t mask = sd->slots - 1;
+    size_t slot = home_slot(sd, page);
+    while (sd->times[slot] != 0 && sd->keys[slot] != page) slot = (slot + 1) & mask;
+    return slot;
+}
+
+static size_t get_last_access(const stack_distance *sd, uint32_t page) {
+    if (sd->last_access) return sd->last_access[page];
+    return sd->times[find_slot(sd, page)];
+}
+
+static void set_last_access(stack_distance *sd, uint32_t page, size_t t) {
+    if (sd->last_access) {
+        sd->last_access[page] = t;
+        return;
+    }
+    size_t slot = find_slot(sd, page);
+    if (sd->times[slot] == 0) {
+        if (2 * (sd->used + 1) > sd->slots) { // rehashes into twice the slots
+            uint32_t *keys = sd->keys;
+            int *times = sd->times;
+            size_t slots = sd->slots;
+            allocate_slots(sd, sd->slot_bits + 1);
+            for (size_t i = 0; i < slots; i++) {
+                if (times[i] == 0) continue;
+                size_t moved = find_slot(sd, keys[i]);
+                sd->keys[moved] = keys[i];
+                sd->times[moved] = times[i];
+            }
+            free(keys);
+            free(times);
+            slot = find_slot(sd, page);
+        }
+        sd->keys[slot] = page;
+        sd->used++;
+    }
+    sd->times[slot] = t;
+}
+
+// empties the slot of the page, moving back the entries of the probe sequence that follows it
+static void clear_last_access(stack_distance *sd, uint32_t page) {
+    if (sd->last_access) {
+        sd->last_access[page] = 0;
+        return;
+    }
+    size_t mask = sd->slots - 1;
+    size_t hole = find_slot(sd, page);
+    if (sd->times[hole] == 0) return;
+    sd->used--;
+    for (size_t slot = (hole + 1) & mask; sd->times[slot] != 0; slot = (slot + 1) & mask) {
+        size_t home = home_slot(sd, sd->keys[slot]);
+        // the entry may fill the hole if its home is not in (hole, slot], cyclically
+        if (((slot - home) & mask) >= ((slot - hole) & mask)) {
+            sd->keys[hole] = sd->keys[slot];
+            sd->times[hole] = sd->times[slot];
+            hole = slot;
+        }
+    }
+    sd->times[hole] = 0;
+}
+
+static void fenwick_add(stack_distance *sd, size_t t, int value) {
+    for (; t <= sd->capacity; t += t & -t) {
+        sd->tree[t] += value;
+    }
+}
+
+static long fenwick_prefix(stack_distance *sd, size_t t) {
+    long sum = 0;
+    for (; t > 0; t -= t & -t) {
+        sum += sd->tree[t];
+    }
+    return sum;
+}
+
+// when timestamps run out, the live ones (one per distinct page) are renumbered 1 .. distinct_pages keeping
+// their order, so memory stays proportional to the number of pages instead of the trace length
+static void compact_timestamps(stack_distance *sd) {
+    size_t live = 0;
+    for (size_t t = 1; t <= sd->now; t++) {
+        uint32_t page = sd->owner[t];
+        if (get_last_access(sd, page) == t) {
+            sd->owner[++live] = page;
+            set_last_access(sd, page, live);
+        }
+    }
+
+    if (live * 2 > sd->capacity) {
+        sd->capacity *= 2;
+        sd->owner = (uint32_t*) realloc(sd->owner, (sd->capacity + 1) * sizeof(uint32_t));
+        sd->tree = (int*) realloc(sd->tree, (sd->capacity + 1) * sizeof(int));
+    }
+
+    // rebuilds the tree with timestamps 1 .. live set: node i covers (i - lowbit(i), i]
+    for (size_t i = 1; i <= sd->capacity; i++) {
+        size_t low = i - (i & -i);
+        size_t high = i < live ? i : live;
+        sd->tree[i] = high > low ? high - low : 0;
+    }
+    sd->now = live;
+}
+
+// records a reference to the page and returns its stack distance (0 for the first reference)
+unsigned long stack_distance_access(stack_distance *sd, uint32_t page) {
+    if (sd->now == sd->capacity) {
+        compact_timestamps(sd);
+    }
+    size_t now = ++sd->now;
+    unsigned long distance = 0;
+    sd->accesses++;
+
+    size_t last = get_last_access(sd, page);
+    if (last != 0) {
+        distance = fenwick_prefix(sd, now - 1) - fenwick_prefix(sd, last) + 1;
+        fenwick_add(sd, last, -1);
+
+        if (distance >= sd->histogram_size) {
+            size_t old_size = sd->histogram_size;
+            while (distance >= sd->histogram_size) sd->histogram_size *= 2;
+            sd->histogram = (unsigned long*) realloc(sd->histogram, sd->histogram_size * sizeof(unsigned long));
+            memset(sd->histogram + old_size, 0, (sd->histogram_size - old_size) * sizeof(unsigned long));
+        }
+        sd->histogram[distance]++;
+    } else {
+        sd->distinct_pages++;
+    }
+
+    set_last_access(sd, page, now);
+    sd->owner[now] = page;
+    fenwick_add(sd, now, 1);
+    return distance;
+}
+
+// forgets a page: its latest timestamp no longer counts in the distances of other pages
+void stack_distance_remove(stack_distance *sd, uint32_t page) {
+    size_t last = get_last_access(sd, page);
+    if (last == 0) return;
+    fenwick_add(sd, last, -1);
+    clear_last_access(sd, page);
+}
+
+// number of page faults an LRU memory with the given number of frames has on the references seen so far
+unsigned long stack_distance_faults(stack_distance *sd, unsigned long frames) {
+    unsigned long faults = sd->distinct_pages;
+    for (size_t d = frames + 1; d < sd->histogram_size; d++) {
+        faults += sd->histogram[d];
+    }
+    return faults;
+}
+
+// prints the page faults and miss ratio for every number of frames from 1 up to max_frames
+// (0 prints up to the number of distinct pages, after which the curve is flat)
+void print_miss_ratio_curve(stack_distance *sd, FILE *out, unsigned int page_size, unsigned long max_frames) {
+    if (max_frames == 0) max_frames = sd->distinct_pages;
+
+    fprintf(out, "# accesses: %lu, distinct pages: %lu\n", sd->accesses, sd->distinct_pages);
+    fprintf(out, "frames,mem_size,page_faults,miss_ratio\n");
+
+    // walks the frame counts downwards so the faults are a running suffix sum of the histogram
+    unsigned long *faults = (unsigned long*) malloc((max_frames + 1) * sizeof(unsigned long));
+    unsigned long suffix = stack_distance_faults(sd, max_frames);
+    for (unsigned long frames = max_frames; frames >= 1; frames--) {
+        faults[frames] = suffix;
+        if (frames < sd->histogram_size) suffix += sd->histogram[frames];
+    }
+    for (unsigned long frames = 1; frames <= max_frames; frames++) {
+        fprintf(out, "%lu,%lu,%lu,%.6f\n", frames, frames * page_size, faults[frames],
+                sd->accesses ? (double) faults[frames] / sd->accesses : 0.0);
+    }
+    free(faults);
+}
+
+// free allocated memory to the analysis
+void free_stack_distance(stack_distance *sd) {
+    if (sd == NULL) return;
+    free(sd->last_access);
+    free(sd->keys);
+    free(sd->times);
+    free(sd->owner);
+    free(sd->tree);
+    free(sd->histogram);
+    free(sd);
+}
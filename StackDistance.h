@@ -0,0 +1,51 @@
+#ifndef STACK_DISTANCE_H
+#define STACK_DISTANCE_H
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+
+// Mattson stack-distance analysis: LRU has the inclusion property, so the reuse distance of each
+// reference (number of distinct pages touched since the previous reference to the same page) tells
+// whether it faults for every memory size at once. Distances are counted with a Fenwick tree over
+// the last-access timestamps: a timestamp is set while it is the latest access to its page.
+// The timestamps are kept in an array over all pages, or in a hash of the pages seen when only a
+// sample of the address space is tracked (shards)
+typedef struct {
+    int *last_access; // latest timestamp of each page (0 if never accessed); NULL with the hash
+    uint32_t *keys; // hash: page of each slot (linear probing)
+    int *times; // hash: latest timestamp of the page of the slot (0 if the slot is empty)
+    size_t slots; // hash: a power of two, at most half full
+    unsigned int slot_bits;
+    size_t used;
+    uint32_t *owner; // page accessed at each timestamp
+    int *tree; // Fenwick tree over timestamps 1 .. capacity
+    size_t capacity;
+    size_t now;
+    size_t number_of_pages;
+
+    unsigned long *histogram; // histogram[d]: references with stack distance d
+    size_t histogram_size;
+    unsigned long distinct_pages; // also the number of cold (compulsory) faults
+    unsigned long accesses;
+} stack_distance;
+
+/* ============ FUNCTIONS ============ */
+
+stack_distance* init_stack_distance(size_t number_of_pages);
+
+stack_distance* init_hashed_stack_distance(size_t expected_pages);
+
+unsigned long stack_distance_access(stack_distance *sd, uint32_t page);
+
+void stack_distance_remove(stack_distance *sd, uint32_t page);
+
+unsigned long stack_distance_faults(stack_distance *sd, unsigned long frames);
+
+void print_miss_ratio_curve(stack_distance *sd, FILE *out, unsigned int page_size, unsigned long max_frames);
+
+void free_stack_distance(stack_distance *sd);
+
+/* =================================== */
+
+#endif
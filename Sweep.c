@@ -0,0 +1,186 @@
+#include "Sweep.h"
+#include <pthread.h>
+#include <string.h>
+
+// the trace is decoded once, in batches, and every batch is fed to all simulations. Workers take
+// simulations from a shared counter, so one batch is spread over the pool while the main thread
+// decodes the next batch into the other buffer
+typedef struct {
+    sweep_config *configs;
+    simulator **sims; // created by the workers on the first batch, so page tables are also built in parallel
+    int count;
+    bool failed; // set by any worker, read by all of them: accessed atomically
+    const uint64_t *addresses; // batch being simulated
+    const char *operations;
+    size_t batch_size;
+    int next_instance;
+    bool done;
+    pthread_barrier_t start;
+    pthread_barrier_t end;
+} sweep_pool;
+
+// reads the configuration list: one "algorithm page_size mem_size table_type" per line, '#' starts a comment.
+// opt is not accepted, since it needs the whole trace before the first batch
+int read_sweep_configs(const char *path, sweep_config **configs) {
+    FILE *file = fopen(path, "r");
+    if (!file) return -1;
+
+    int count = 0, capacity = 16;
+    *configs = (sweep_config*) malloc(capacity * sizeof(sweep_config));
+
+    char line[256];
+    while (fgets(line, sizeof(line), file)) {
+        char *comment = strchr(line, '#');
+        if (comment) *comment = '\0';
+
+        sweep_config config;
+        int table_type;
+        int fields = sscanf(line, "%15s %u %u %d", config.algorithm, &config.page_size, &config.mem_size, &table_type);
+        if (fields <= 0) continue; // blank line
+        if (fields != 4 || get_replacement_function(config.algorithm) == NULL || strcmp(config.algorithm, "opt") == 0 || table_type < DENSE_PAGE_TABLE || table_type > HASHED || config.page_size == 0) {
+            fclose(file);
+            free(*configs);
+            *configs = NULL;
+            return -1;
+        }
+        config.table_type = table_type;
+
+        if (count == capacity) {
+            capacity *= 2;
+            *configs = (sweep_config*) realloc(*configs, capacity * sizeof(sweep_config));
+        }
+        (*configs)[count++] = config;
+    }
+    fclose(file);
+    return count;
+}
+
+// fills the buffers with up to SWEEP_BATCH_SIZE accesses; returns how many were read
+static size_t read_batch(trace_reader *trace, uint64_t *addresses, char *operations) {
+    return next_accesses(trace, addresses, operations, SWEEP_BATCH_SIZE);
+}
+
+static void* sweep_worker(void *arg) {
+    sweep_pool *pool = (sweep_pool*) arg;
+    while (true) {
+        pthread_barrier_wait(&pool->start);
+        if (pool->done) break;
+
+        int i;
+        while ((i = __atomic_fetch_add(&pool->next_instance, 1, __ATOMIC_RELAXED)) < pool->count) {
+            if (pool->sims[i] == NULL) {
+                pool->sims[i] = init_simulator(pool->configs[i].algorithm, pool->configs[i].page_size, pool->configs[i].mem_size,
+                                               pool->configs[i].table_type, NULL);
+                if (pool->sims[i] == NULL) {
+                    __atomic_store_n(&pool->failed, true, __ATOMIC_RELAXED);
+                }
+            }
+            if (__atomic_load_n(&pool->failed, __ATOMIC_RELAXED)) continue;
+
+            simulate_batch(pool->sims[i], pool->addresses, pool->operations, pool->batch_size);
+        }
+        pthread_barrier_wait(&pool->end);
+    }
+    return NULL;
+}
+
+static void print_results(simulator **sims, int count, FILE *out, bool json) {
+    if (json) {
+        fprintf(out, "[\n");
+    } else {
+        fprintf(out, "algorithm,page_size,mem_size,table_type,accesses,memory_accesses,page_faults,dirty_pages,clock_steps,page_table_bytes\n");
+    }
+    for (int i = 0; i < count; i++) {
+        simulator *sim = sims[i];
+        page_table_usage usage;
+        get_page_table_usage(sim->page_table, &usage);
+        if (json) {
+            fprintf(out, "  {\"algorithm\": \"%s\", \"page_size\": %u, \"mem_size\": %u, \"table_type\": %d, \"accesses\": %lu, "
+                         "\"memory_accesses\": %d, \"page_faults\": %u, \"dirty_pages\": %u, \"clock_steps\": %lu, \"page_table_bytes\": %zu}%s\n",
+                    sim->algorithm, sim->page_size, sim->mem_size, sim->table_type, sim->total_accesses,
+                    sim->mem_access, sim->page_faults, sim->dirty_pages, sim->clock->steps, usage.bytes, i + 1 < count ? "," : "");
+        } else {
+            fprintf(out, "%s,%u,%u,%d,%lu,%d,%u,%u,%lu,%zu\n", sim->algorithm, sim->page_size, sim->mem_size, sim->table_type,
+                    sim->total_accesses, sim->mem_access, sim->page_faults, sim->dirty_pages, sim->clock->steps, usage.bytes);
+        }
+    }
+    if (json) {
+        fprintf(out, "]\n");
+    }
+}
+
+// runs every configuration over the trace on a pool of threads and prints one row per configuration.
+// Returns -1 if a simulation can't be created, -2 if the trace has process ids (the configurations
+// simulate a single address space) and -3 if it has 64-bit addresses and some configuration uses a
+// table of 32-bit addresses. Such traces are refused as soon as the ids or addresses are seen
+int run_sweep(trace_reader *trace, sweep_config *configs, int count, int threads, FILE *out, bool json) {
+    sweep_pool pool;
+    pool.configs = configs;
+    pool.count = count;
+    pool.failed = false;
+    pool.next_instance = 0;
+    pool.done = false;
+    pool.sims = (simulator**) calloc(count, sizeof(simulator*));
+
+    bool narrow = false; // some table splits 32-bit addresses
+    for (int i = 0; i < count; i++) {
+        if (table_address_size(configs[i].table_type) == ADDRESS_SIZE) narrow = true;
+    }
+
+    if (threads < 1) threads = 1;
+    if (threads > count) threads = count;
+    pthread_barrier_init(&pool.start, NULL, threads + 1);
+    pthread_barrier_init(&pool.end, NULL, threads + 1);
+    pthread_t *workers = (pthread_t*) malloc(threads * sizeof(pthread_t));
+    for (int t = 0; t < threads; t++) {
+        pthread_create(&workers[t], NULL, sweep_worker, &pool);
+    }
+
+    // double buffering: batch `current` is simulated while the next one is decoded. The first round
+    // always runs, even on an empty trace, since it is the one that creates the simulations
+    uint64_t *addresses[2];
+    char *operations[2];
+    for (int b = 0; b < 2; b++) {
+        addresses[b] = (uint64_t*) malloc(SWEEP_BATCH_SIZE * sizeof(uint64_t));
+        operations[b] = (char*) malloc(SWEEP_BATCH_SIZE * sizeof(char));
+    }
+
+    int current = 0;
+    size_t batch_size = read_batch(trace, addresses[current], operations[current]);
+    do {
+        pool.addresses = addresses[current];
+        pool.operations = operations[current];
+        pool.batch_size = batch_size;
+        pool.next_instance = 0;
+        pthread_barrier_wait(&pool.start);
+
+        size_t next_size = read_batch(trace, addresses[1 - current], operations[1 - current]);
+
+        pthread_barrier_wait(&pool.end);
+        current = 1 - current;
+        batch_size = next_size;
+    } while (batch_size > 0 && !trace_has_pids(trace) && !(narrow && trace_is_wide(trace)));
+
+    pool.done = true;
+    pthread_barrier_wait(&pool.start);
+    for (int t = 0; t < threads; t++) {
+        pthread_join(workers[t], NULL);
+    }
+
+    bool processes = trace_has_pids(trace);
+    bool folded = narrow && trace_is_wide(trace);
+    if (!pool.failed && !processes && !folded) {
+        print_results(pool.sims, count, out, json);
+    }
+
+    for (int b = 0; b < 2; b++) {
+        free(addresses[b]);
+        free(operations[b]);
+    }
+    free(workers);
+    pthread_barrier_destroy(&pool.start);
+    pthread_barrier_destroy(&pool.end);
+    for (int i = 0; i < count; i++) free_simulator(pool.sims[i]);
+    free(pool.sims);
+    return pool.failed ? -1 : processes ? -2 : folded ? -3 : 0;
+}
@@ -0,0 +1,28 @@
+#ifndef SWEEP_H
+#define SWEEP_H
+
+#include <stdio.h>
+#include <stdbool.h>
+#include "Simulator.h"
+#include "Trace.h"
+
+#define SWEEP_BATCH_SIZE 65536
+#define SWEEP_ALGORITHM_LENGTH 16
+
+// one point of the configuration grid
+typedef struct {
+    char algorithm[SWEEP_ALGORITHM_LENGTH];
+    unsigned int page_size;
+    unsigned int mem_size;
+    tableType table_type;
+} sweep_config;
+
+/* ============ FUNCTIONS ============ */
+
+int read_sweep_configs(const char *path, sweep_config **configs);
+
+int run_sweep(trace_reader *trace, sweep_config *configs, int count, int threads, FILE *out, bool json);
+
+/* =================================== */
+
+#endif
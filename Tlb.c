@@ -0,0 +1,278 @@
+#include "Tlb.h"
+#include <string.h>
+#ifdef __SSE2__
+#include <immintrin.h>
+#endif
+
+// splitmix64, for random replacement within a set
+static uint64_t next_random(uint64_t *state) {
+    uint64_t z = (*state += 0x9E3779B97F4A7C15ULL);
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+    return z ^ (z >> 31);
+}
+
+// "entries[xways]" (no ways: fully associative); the number of sets must be a power of two
+static bool parse_level(const char *text, size_t *entries, size_t *ways) {
+    char *end;
+    *entries = strtoul(text, &end, 10);
+    *ways = 0;
+    if (*end == 'x') *ways = strtoul(end + 1, &end, 10);
+    if (*end != '\0' || *entries == 0) return false;
+    if (*ways == 0) *ways = *entries;
+    if (*ways > *entries || *entries % *ways != 0) return false;
+    size_t sets = *entries / *ways;
+    return (sets & (sets - 1)) == 0 && *ways <= UINT16_MAX;
+}
+
+// reads a TLB description: comma separated items, all optional
+//   64x4       L1 with 64 entries in 4 ways (64: fully associative); default 64x4
+//   l2=1536x12 second level, looked up on L1 misses
+//   lru|random replacement within a set; default lru
+//   flush=N    context switch every N accesses, emptying the TLB
+//   asid=N     context switch every N accesses, entries tagged by address space survive it
+bool parse_tlb_config(const char *spec, tlb_config *config) {
+    memset(config, 0, sizeof(*config));
+    config->levels = 1;
+    config->entries[0] = 64;
+    config->ways[0] = 4;
+    config->replacement = TLB_LRU;
+    config->switch_mode = TLB_FLUSH;
+
+    char buffer[256];
+    snprintf(buffer, sizeof(buffer), "%s", spec);
+    for (char *item = strtok(buffer, ","); item != NULL; item = strtok(NULL, ",")) {
+        if (strcmp(item, "lru") == 0) {
+            config->replacement = TLB_LRU;
+        } else if (strcmp(item, "random") == 0) {
+            config->replacement = TLB_RANDOM;
+        } else if (strncmp(item, "flush", 5) == 0 || strncmp(item, "asid", 4) == 0) {
+            config->switch_mode = item[0] == 'f' ? TLB_FLUSH : TLB_ASID;
+            const char *value = strchr(item, '=');
+            config->switch_interval = value ? strtoul(value + 1, NULL, 10) : 0;
+        } else if (strncmp(item, "l2=", 3) == 0) {
+            if (!parse_level(item + 3, &config->entries[1], &config->ways[1])) return false;
+            config->levels = 2;
+        } else if (!parse_level(strncmp(item, "l1=", 3) == 0 ? item + 3 : item, &config->entries[0], &config->ways[0])) {
+            return false;
+        }
+    }
+    return true;
+}
+
+static bool init_level(tlb_level *level, size_t entries, size_t ways, size_t frames) {
+    level->entries = entries;
+    level->ways = ways;
+    level->sets = entries / ways;
+    level->set_mask = level->sets - 1;
+    level->tags = (uint32_t*) calloc(entries, sizeof(uint32_t));
+    level->tags_high = (uint32_t*) calloc(entries, sizeof(uint32_t));
+    level->asids = (uint16_t*) calloc(entries, sizeof(uint16_t));
+    level->frames = (int*) malloc(entries * sizeof(int));
+    level->order = (uint16_t*) malloc(entries * sizeof(uint16_t));
+    level->frame_entry = (int*) malloc(frames * sizeof(int));
+    if (!level->tags || !level->tags_high || !level->asids || !level->frames || !level->order || !level->frame_entry) return false;
+    for (size_t i = 0; i < entries; i++) level->order[i] = i % ways;
+    for (size_t i = 0; i < entries; i++) level->frames[i] = -1;
+    for (size_t f = 0; f < frames; f++) level->frame_entry[f] = -1;
+    return true;
+}
+
+// creates the TLB described by the configuration for a memory of `frames` frames (NULL on failure)
+tlb* init_tlb(const tlb_config *config, size_t frames) {
+    tlb *t = (tlb*) calloc(1, sizeof(tlb));
+    if (!t) return NULL;
+    t->levels = config->levels;
+    t->replacement = config->replacement;
+    t->switch_mode = config->switch_mode;
+    t->switch_interval = config->switch_interval;
+    t->rng = 1;
+    for (int l = 0; l < t->levels; l++) {
+        if (!init_level(&t->level[l], config->entries[l], config->ways[l], frames)) {
+            free_tlb(t);
+            return NULL;
+        }
+    }
+    return t;
+}
+
+// way of the set holding the page in the current address space, or -1. The low bits of the page are
+// compared with every way at once (8 per instruction with AVX2, 4 with SSE2); a match is then checked
+// against the high bits, the address space and the entry being in use
+static inline int find_way(const tlb_level *level, size_t first, uint64_t page, uint16_t asid) {
+    const uint32_t *tags = level->tags + first;
+    uint32_t tag = (uint32_t) page;
+    uint32_t high = (uint32_t) (page >> 32);
+    size_t ways = level->ways;
+    size_t w = 0;
+#define CHECK_WAY(way) \
+    if (level->tags_high[first + (way)] == high && level->asids[first + (way)] == asid && level->frames[first + (way)] != -1) return (way)
+#ifdef __AVX2__
+    __m256i key8 = _mm256_set1_epi32((int) tag);
+    for (; w + 8 <= ways; w += 8) {
+        __m256i found = _mm256_cmpeq_epi32(_mm256_loadu_si256((const __m256i*) (tags + w)), key8);
+        unsigned int mask = _mm256_movemask_ps(_mm256_castsi256_ps(found));
+        for (; mask != 0; mask &= mask - 1) {
+            int way = w + __builtin_ctz(mask);
+            CHECK_WAY(way);
+        }
+    }
+#endif
+#ifdef __SSE2__
+    __m128i key4 = _mm_set1_epi32((int) tag);
+    for (; w + 4 <= ways; w += 4) {
+        __m128i found = _mm_cmpeq_epi32(_mm_loadu_si128((const __m128i*) (tags + w)), key4);
+        unsigned int mask = _mm_movemask_ps(_mm_castsi128_ps(found));
+        for (; mask != 0; mask &= mask - 1) {
+            int way = w + __builtin_ctz(mask);
+            CHECK_WAY(way);
+        }
+    }
+#endif
+    for (; w < ways; w++) {
+        if (tags[w] == tag) {
+            CHECK_WAY((int) w);
+        }
+    }
+#undef CHECK_WAY
+    return -1;
+}
+
+// position of the way in the recency order of its set
+static inline size_t order_position(const uint16_t *order, size_t way) {
+    size_t position = 0;
+    while (order[position] != way) position++;
+    return position;
+}
+
+// the way at the position becomes the most recently used one
+static inline void move_to_front(uint16_t *order, size_t position) {
+    uint16_t way = order[position];
+    memmove(order + 1, order, position * sizeof(uint16_t));
+    order[0] = way;
+}
+
+static void clear_entry(tlb_level *level, size_t entry) {
+    if (level->frames[entry] == -1) return;
+    size_t set = level->tags[entry] & level->set_mask; // no division: the set comes from the page
+    size_t way = entry - set * level->ways;
+    uint16_t *order = level->order + set * level->ways;
+    size_t position = order_position(order, way);
+    memmove(order + position, order + position + 1, (level->ways - position - 1) * sizeof(uint16_t));
+    order[level->ways - 1] = way; // free ways are taken first
+    level->frame_entry[level->frames[entry]] = -1;
+    level->frames[entry] = -1;
+}
+
+// puts the translation in its set, over a free way if there is one, else over the lru or a random way
+static void fill_level(tlb *t, tlb_level *level, uint64_t page, int frame) {
+    if (level->frame_entry[frame] != -1) clear_entry(level, level->frame_entry[frame]);
+
+    size_t set = page & level->set_mask;
+    size_t first = set * level->ways;
+    uint16_t *order = level->order + first;
+    size_t position = level->ways - 1;
+    size_t way = order[position]; // a free way or the lru one
+    if (level->frames[first + way] != -1 && t->replacement == TLB_RANDOM) {
+        way = next_random(&t->rng) % level->ways;
+        position = order_position(order, way);
+    }
+
+    size_t entry = first + way;
+    if (level->frames[entry] != -1) level->frame_entry[level->frames[entry]] = -1; // evicted
+    level->tags[entry] = (uint32_t) page;
+    level->tags_high[entry] = (uint32_t) (page >> 32);
+    level->asids[entry] = t->asid;
+    level->frames[entry] = frame;
+    level->frame_entry[frame] = entry;
+    move_to_front(order, position);
+}
+
+// translates the page through the TLB; returns false when every level missed and the page table must
+// be walked (the caller then gives the translation to tlb_fill). An L2 hit is copied into L1
+bool tlb_lookup(tlb *t, uint64_t page) {
+    t->accesses++;
+    if (t->switch_interval && t->accesses % t->switch_interval == 0) tlb_switch_context(t, t->asid);
+
+    for (int l = 0; l < t->levels; l++) {
+        tlb_level *level = &t->level[l];
+        size_t set = page & level->set_mask;
+        size_t first = set * level->ways;
+        int way = find_way(level, first, page, t->asid);
+        if (way != -1) {
+            size_t entry = first + way;
+            if (t->replacement == TLB_LRU) move_to_front(level->order + first, order_position(level->order + first, way));
+            level->hits++;
+            if (l > 0) fill_level(t, &t->level[0], page, level->frames[entry]);
+            return true;
+        }
+        level->misses++;
+    }
+    return false;
+}
+
+// caches the translation found by the page table walk in every level
+void tlb_fill(tlb *t, uint64_t page, int frame) {
+    for (int l = 0; l < t->levels; l++) {
+        fill_level(t, &t->level[l], page, frame);
+    }
+}
+
+// shootdown: the page in the frame was evicted, its translation is no longer valid
+void tlb_invalidate_frame(tlb *t, int frame) {
+    for (int l = 0; l < t->levels; l++) {
+        tlb_level *level = &t->level[l];
+        if (level->frame_entry[frame] != -1) clear_entry(level, level->frame_entry[frame]);
+    }
+}
+
+// a context switch to the address space: flushing TLBs lose every entry, tagged TLBs keep them
+void tlb_switch_context(tlb *t, uint16_t asid) {
+    t->switches++;
+    t->asid = asid;
+    if (t->switch_mode == TLB_ASID) return;
+    for (int l = 0; l < t->levels; l++) {
+        for (size_t e = 0; e < t->level[l].entries; e++) {
+            clear_entry(&t->level[l], e);
+        }
+    }
+}
+
+// translations that did not need a page table walk
+unsigned long tlb_hits(const tlb *t) {
+    unsigned long hits = 0;
+    for (int l = 0; l < t->levels; l++) hits += t->level[l].hits;
+    return hits;
+}
+
+void print_tlb_stats(const tlb *t, FILE *out) {
+    for (int l = 0; l < t->levels; l++) {
+        const tlb_level *level = &t->level[l];
+        unsigned long lookups = level->hits + level->misses;
+        fprintf(out, "TLB L%d: %zu entries, ", l + 1, level->entries);
+        if (level->sets == 1) {
+            fprintf(out, "fully associative");
+        } else {
+            fprintf(out, "%zu-way", level->ways);
+        }
+        fprintf(out, ", %s\n", t->replacement == TLB_LRU ? "lru" : "random");
+        fprintf(out, "TLB L%d hit rate: %.4f (%lu hits, %lu lookups)\n", l + 1,
+                lookups ? (double) level->hits / lookups : 0.0, level->hits, lookups);
+    }
+    fprintf(out, "TLB hit rate: %.4f (%lu hits, %lu lookups)\n", t->accesses ? (double) tlb_hits(t) / t->accesses : 0.0,
+            tlb_hits(t), t->accesses);
+    fprintf(out, "Context switches: %lu (%s)\n", t->switches, t->switch_mode == TLB_FLUSH ? "flush" : "asid");
+}
+
+void free_tlb(tlb *t) {
+    if (t == NULL) return;
+    for (int l = 0; l < TLB_MAX_LEVELS; l++) {
+        free(t->level[l].tags);
+        free(t->level[l].tags_high);
+        free(t->level[l].asids);
+        free(t->level[l].frames);
+        free(t->level[l].order);
+        free(t->level[l].frame_entry);
+    }
+    free(t);
+}
@@ -0,0 +1,74 @@
+#ifndef TLB_H
+#define TLB_H
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <stdint.h>
+
+#define TLB_MAX_LEVELS 2
+
+typedef enum { TLB_LRU, TLB_RANDOM } tlbReplacement;
+typedef enum { TLB_FLUSH, TLB_ASID } tlbSwitch; // what a context switch does to the entries
+
+// one TLB level: `sets` sets of `ways` entries (a single set when fully associative). The tags of a set
+// are contiguous so a lookup compares all of its ways with a few vector instructions
+typedef struct {
+    size_t entries;
+    size_t ways;
+    size_t sets;
+    uint32_t set_mask;
+    uint32_t *tags; // low 32 bits of the page of each entry, compared first
+    uint32_t *tags_high; // high 32 bits, checked on a match
+    uint16_t *asids;
+    int *frames; // -1 if the entry is free
+    uint16_t *order; // ways of each set from the most to the least recently used, free ways last
+    int *frame_entry; // frame -> entry translating to it (-1 if none), for shootdowns on eviction
+    unsigned long hits;
+    unsigned long misses;
+} tlb_level;
+
+typedef struct {
+    int levels; // 1 or 2
+    size_t entries[TLB_MAX_LEVELS];
+    size_t ways[TLB_MAX_LEVELS]; // 0: fully associative
+    tlbReplacement replacement;
+    tlbSwitch switch_mode;
+    unsigned long switch_interval; // accesses between context switches (0: never)
+} tlb_config;
+
+typedef struct {
+    tlb_level level[TLB_MAX_LEVELS];
+    int levels;
+    tlbReplacement replacement;
+    tlbSwitch switch_mode;
+    unsigned long switch_interval;
+    unsigned long switches;
+    uint16_t asid;
+    unsigned long accesses;
+    uint64_t rng;
+} tlb;
+
+/* ============ FUNCTIONS ============ */
+
+bool parse_tlb_config(const char *spec, tlb_config *config);
+
+tlb* init_tlb(const tlb_config *config, size_t frames);
+
+bool tlb_lookup(tlb *tlb, uint64_t page);
+
+void tlb_fill(tlb *tlb, uint64_t page, int frame);
+
+void tlb_invalidate_frame(tlb *tlb, int frame);
+
+void tlb_switch_context(tlb *tlb, uint16_t asid);
+
+unsigned long tlb_hits(const tlb *tlb);
+
+void print_tlb_stats(const tlb *tlb, FILE *out);
+
+void free_tlb(tlb *tlb);
+
+/* =================================== */
+
+#endif
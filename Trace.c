@@ -0,0 +1,287 @@
+#include "Trace.h"
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <inttypes.h>
+
+#define CONVERT_BATCH_SIZE 65536
+
+// maps a binary trace into memory; returns false if the file is not a valid binary trace
+static bool map_binary_trace(trace_reader *trace, int fd) {
+    struct stat st;
+    if (fstat(fd, &st) != 0 || (size_t) st.st_size < sizeof(trace_header)) return false;
+
+    void *map = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    if (map == MAP_FAILED) return false;
+
+    const trace_header *header = (const trace_header*) map;
+    uint64_t file_size = st.st_size;
+    bool wide = header->version == TRACE_VERSION_64 || header->version == TRACE_VERSION_64_PID;
+    bool with_pids = header->version == TRACE_VERSION_PID || header->version == TRACE_VERSION_64_PID;
+    size_t address_size = wide ? sizeof(uint64_t) : sizeof(uint32_t);
+    size_t access_size = address_size + (with_pids ? sizeof(uint32_t) : 0); // bytes per access besides the write bit
+    if (memcmp(header->magic, TRACE_MAGIC, sizeof(header->magic)) != 0 ||
+        header->version < TRACE_VERSION || header->version > TRACE_VERSION_64_PID ||
+        header->header_size < sizeof(trace_header) || header->header_size % address_size != 0 ||
+        header->header_size > file_size || header->count > (file_size - header->header_size) / access_size ||
+        file_size < header->header_size + header->count * access_size + (header->count + 7) / 8) {
+        munmap(map, st.st_size);
+        return false;
+    }
+    madvise(map, st.st_size, MADV_SEQUENTIAL);
+
+    trace->format = TRACE_BINARY;
+    trace->map = map;
+    trace->map_size = st.st_size;
+    trace->count = header->count;
+    const uint8_t *addresses = (const uint8_t*) map + header->header_size;
+    if (wide) {
+        trace->addresses_64 = (const uint64_t*) addresses;
+    } else {
+        trace->addresses = (const uint32_t*) addresses;
+    }
+    if (with_pids) trace->pids = (const uint32_t*) (addresses + header->count * address_size);
+    trace->writes = addresses + header->count * access_size;
+    return true;
+}
+
+// number of threads parsing text traces: one per online processor, up to PARSE_MAX_THREADS
+static int parse_threads() {
+    long processors = sysconf(_SC_NPROCESSORS_ONLN);
+    if (processors < 1) return 1;
+    return processors > PARSE_MAX_THREADS ? PARSE_MAX_THREADS : (int) processors;
+}
+
+// opens a trace, detecting its format by the magic number at the start of the file. The path "-"
+// reads a text trace from stdin (binary traces must be files, they are read through mmap)
+trace_reader* open_trace(const char *path) {
+    int fd = strcmp(path, "-") == 0 ? dup(STDIN_FILENO) : open(path, O_RDONLY);
+    if (fd < 0) return NULL;
+
+    trace_reader *trace = (trace_reader*) calloc(1, sizeof(trace_reader));
+    if (!map_binary_trace(trace, fd)) {
+        trace->format = TRACE_TEXT;
+        trace->pipeline = start_trace_pipeline(fd, parse_threads());
+        if (trace->pipeline == NULL) {
+            close(fd);
+            free(trace);
+            return NULL;
+        }
+        return trace;
+    }
+    close(fd); // the mapping stays valid after the descriptor is closed
+    return trace;
+}
+
+// reads the next access of the trace; returns false when the trace is over
+bool next_access(trace_reader *trace, uint64_t *addr, char *rw) {
+    return next_accesses(trace, addr, rw, 1) == 1;
+}
+
+// reads up to `max` accesses at once; returns how many (fewer than `max` only at the end of the trace)
+size_t next_accesses(trace_reader *trace, uint64_t *addresses, char *operations, size_t max) {
+    return next_process_accesses(trace, addresses, operations, NULL, max);
+}
+
+// same as next_accesses, also reading the process of each access into `pids` (0 for accesses without one)
+size_t next_process_accesses(trace_reader *trace, uint64_t *addresses, char *operations, uint32_t *pids, size_t max) {
+    if (trace->format == TRACE_TEXT) {
+        return pipeline_next(trace->pipeline, addresses, operations, pids, max);
+    }
+    size_t n = trace->count - trace->position < max ? trace->count - trace->position : max;
+    if (trace->addresses_64) {
+        memcpy(addresses, trace->addresses_64 + trace->position, n * sizeof(uint64_t));
+    } else {
+        for (size_t k = 0; k < n; k++) {
+            addresses[k] = trace->addresses[trace->position + k];
+        }
+    }
+    for (size_t k = 0; k < n; k++) {
+        uint64_t i = trace->position + k;
+        operations[k] = (trace->writes[i >> 3] >> (i & 7)) & 1 ? 'W' : 'R';
+    }
+    if (pids) {
+        if (trace->pids) {
+            memcpy(pids, trace->pids + trace->position, n * sizeof(uint32_t));
+        } else {
+            memset(pids, 0, n * sizeof(uint32_t));
+        }
+    }
+    trace->position += n;
+    return n;
+}
+
+// whether the trace has process ids: binary traces know it from their version, text traces once a
+// line with a process id was read
+bool trace_has_pids(const trace_reader *trace) {
+    return trace->format == TRACE_TEXT ? trace->pipeline->has_pids : trace->pids != NULL;
+}
+
+// whether the trace has addresses above 32 bits: binary traces know it from their version (2 and 4), text
+// traces once such an address was read
+bool trace_is_wide(const trace_reader *trace) {
+    return trace->format == TRACE_TEXT ? trace->pipeline->wide : trace->addresses_64 != NULL;
+}
+
+// reads the rest of the trace into memory at once (used when the whole trace must be seen before
+// simulating, as in opt); the process ids are only read if `pids` is not NULL. Returns the number of accesses
+size_t load_trace(trace_reader *trace, uint64_t **addresses, char **operations, uint32_t **pids) {
+    size_t count = 0;
+    size_t capacity = trace->format == TRACE_BINARY && trace->count > trace->position ? trace->count - trace->position : 65536;
+    *addresses = (uint64_t*) malloc(capacity * sizeof(uint64_t));
+    *operations = (char*) malloc(capacity * sizeof(char));
+    if (pids) *pids = (uint32_t*) malloc(capacity * sizeof(uint32_t));
+    while (true) {
+        if (count == capacity) {
+            capacity *= 2;
+            *addresses = (uint64_t*) realloc(*addresses, capacity * sizeof(uint64_t));
+            *operations = (char*) realloc(*operations, capacity * sizeof(char));
+            if (pids) *pids = (uint32_t*) realloc(*pids, capacity * sizeof(uint32_t));
+        }
+        size_t n = next_process_accesses(trace, *addresses + count, *operations + count, pids ? *pids + count : NULL, capacity - count);
+        if (n == 0) break;
+        count += n;
+    }
+    return count;
+}
+
+// closes the trace and unmaps binary traces
+void close_trace(trace_reader *trace) {
+    if (trace == NULL) return;
+    if (trace->format == TRACE_TEXT) {
+        stop_trace_pipeline(trace->pipeline);
+    } else {
+        munmap(trace->map, trace->map_size);
+    }
+    free(trace);
+}
+
+static void write_header(FILE *out, bool wide, bool with_pids, uint64_t count) {
+    trace_header header;
+    memcpy(header.magic, TRACE_MAGIC, sizeof(header.magic));
+    if (with_pids) {
+        header.version = wide ? TRACE_VERSION_64_PID : TRACE_VERSION_PID;
+    } else {
+        header.version = wide ? TRACE_VERSION_64 : TRACE_VERSION;
+    }
+    header.header_size = sizeof(trace_header);
+    header.count = count;
+    fwrite(&header, sizeof(header), 1, out);
+}
+
+// translates a text trace ("%lx %c [pid]" per line) into the binary format; returns the number of
+// accesses or -1. A first pass finds whether any address needs 64 bits (if none does, the addresses
+// are stored in 32 bits) and whether any line has a process id (if none has, no ids are stored)
+long convert_trace(const char *text_path, const char *binary_path) {
+    uint64_t *addresses = (uint64_t*) malloc(CONVERT_BATCH_SIZE * sizeof(uint64_t));
+    char *operations = (char*) malloc(CONVERT_BATCH_SIZE * sizeof(char));
+    uint32_t *pids = (uint32_t*) malloc(CONVERT_BATCH_SIZE * sizeof(uint32_t));
+    trace_reader *in = open_trace(text_path);
+    if (!in) {
+        free(addresses);
+        free(operations);
+        free(pids);
+        return -1;
+    }
+    uint64_t count = 0, highest = 0;
+    size_t n;
+    while ((n = next_accesses(in, addresses, operations, CONVERT_BATCH_SIZE)) > 0) {
+        for (size_t i = 0; i < n; i++) {
+            if (addresses[i] > highest) highest = addresses[i];
+        }
+        count += n;
+    }
+    bool with_pids = trace_has_pids(in);
+    close_trace(in);
+    bool wide = highest > UINT32_MAX;
+    size_t address_size = wide ? sizeof(uint64_t) : sizeof(uint32_t);
+
+    FILE *out = fopen(binary_path, "wb");
+    in = out ? open_trace(text_path) : NULL;
+    if (!in) {
+        if (out) fclose(out);
+        free(addresses);
+        free(operations);
+        free(pids);
+        return -1;
+    }
+    write_header(out, wide, with_pids, count);
+
+    // addresses (and process ids, which go right after them) are streamed to their place in the file
+    // while the write bitmap is kept in memory (1 bit per access)
+    long pids_start = sizeof(trace_header) + count * address_size;
+    uint8_t *writes = (uint8_t*) calloc((count + 7) / 8 + 1, 1);
+    uint32_t *narrow = (uint32_t*) malloc(CONVERT_BATCH_SIZE * sizeof(uint32_t));
+    uint64_t position = 0;
+    while (position < count && (n = next_process_accesses(in, addresses, operations, pids, CONVERT_BATCH_SIZE)) > 0) {
+        if (n > count - position) n = count - position;
+        if (with_pids) {
+            fseek(out, pids_start + position * sizeof(uint32_t), SEEK_SET);
+            fwrite(pids, sizeof(uint32_t), n, out);
+            fseek(out, sizeof(trace_header) + position * address_size, SEEK_SET);
+        }
+        if (wide) {
+            fwrite(addresses, sizeof(uint64_t), n, out);
+        } else {
+            for (size_t i = 0; i < n; i++) narrow[i] = (uint32_t) addresses[i];
+            fwrite(narrow, sizeof(uint32_t), n, out);
+        }
+        for (size_t i = 0; i < n; i++, position++) {
+            if (operations[i] == 'W') writes[position / 8] |= 1 << (position % 8);
+        }
+    }
+    fseek(out, pids_start + (with_pids ? count * sizeof(uint32_t) : 0), SEEK_SET);
+    fwrite(writes, 1, (count + 7) / 8, out);
+
+    free(narrow);
+    free(writes);
+    free(addresses);
+    free(operations);
+    free(pids);
+    close_trace(in);
+    bool failed = ferror(out) || position != count;
+    if (fclose(out) != 0 || failed) return -1;
+    return count;
+}
+
+// writes accesses held in memory as a text or a binary trace (64-bit only if some address needs it).
+// Process ids are written only if `pids` is not NULL; returns 0, or -1 on failure
+int write_trace(const char *path, traceFormat format, const uint64_t *addresses, const char *operations, const uint32_t *pids, size_t count) {
+    FILE *out = fopen(path, format == TRACE_BINARY ? "wb" : "w");
+    if (!out) return -1;
+
+    if (format == TRACE_TEXT) {
+        for (size_t i = 0; i < count; i++) {
+            if (pids) {
+                fprintf(out, "%08" PRIx64 " %c %" PRIu32 "\n", addresses[i], operations[i], pids[i]);
+            } else {
+                fprintf(out, "%08" PRIx64 " %c\n", addresses[i], operations[i]);
+            }
+        }
+    } else {
+        bool wide = false;
+        for (size_t i = 0; i < count && !wide; i++) wide = addresses[i] > UINT32_MAX;
+        write_header(out, wide, pids != NULL, count);
+        if (wide) {
+            fwrite(addresses, sizeof(uint64_t), count, out);
+        } else {
+            for (size_t i = 0; i < count; i++) {
+                uint32_t addr = (uint32_t) addresses[i];
+                fwrite(&addr, sizeof(addr), 1, out);
+            }
+        }
+        if (pids) fwrite(pids, sizeof(uint32_t), count, out);
+
+        uint8_t *writes = (uint8_t*) calloc((count + 7) / 8 + 1, 1);
+        for (size_t i = 0; i < count; i++) {
+            if (operations[i] == 'W') writes[i / 8] |= 1 << (i % 8);
+        }
+        fwrite(writes, 1, (count + 7) / 8, out);
+        free(writes);
+    }
+
+    bool failed = ferror(out);
+    if (fclose(out) != 0 || failed) return -1;
+    return 0;
+}
@@ -0,0 +1,66 @@
+#ifndef TRACE_H
+#define TRACE_H
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+#include "Parser.h"
+
+#define TRACE_MAGIC "SMVTRACE"
+#define TRACE_VERSION 1 // 32-bit addresses
+#define TRACE_VERSION_64 2 // 64-bit addresses
+#define TRACE_VERSION_PID 3 // 32-bit addresses and a process id per access
+#define TRACE_VERSION_64_PID 4 // 64-bit addresses and a process id per access
+
+typedef enum { TRACE_TEXT, TRACE_BINARY } traceFormat;
+
+// binary trace layout: this header, then `count` packed addresses (32 bits in versions 1 and 3, 64 bits
+// in versions 2 and 4, host byte order), in versions 3 and 4 `count` 32-bit process ids, then a bitmap
+// with one bit per access (bit i set if access i is a write)
+typedef struct {
+    char magic[8];
+    uint32_t version;
+    uint32_t header_size;
+    uint64_t count;
+} trace_header;
+
+typedef struct {
+    traceFormat format;
+    trace_pipeline *pipeline; // text traces are parsed by a pipeline of threads
+    void *map; // binary traces are read in place through mmap
+    size_t map_size;
+    const uint32_t *addresses; // version 1
+    const uint64_t *addresses_64; // version 2
+    const uint32_t *pids; // versions 3 and 4
+    const uint8_t *writes;
+    uint64_t count;
+    uint64_t position;
+} trace_reader;
+
+/* ============ FUNCTIONS ============ */
+
+trace_reader* open_trace(const char *path);
+
+bool next_access(trace_reader *trace, uint64_t *addr, char *rw);
+
+size_t next_accesses(trace_reader *trace, uint64_t *addresses, char *operations, size_t max);
+
+size_t next_process_accesses(trace_reader *trace, uint64_t *addresses, char *operations, uint32_t *pids, size_t max);
+
+bool trace_has_pids(const trace_reader *trace);
+
+bool trace_is_wide(const trace_reader *trace);
+
+void close_trace(trace_reader *trace);
+
+size_t load_trace(trace_reader *trace, uint64_t **addresses, char **operations, uint32_t **pids);
+
+long convert_trace(const char *text_path, const char *binary_path);
+
+int write_trace(const char *path, traceFormat format, const uint64_t *addresses, const char *operations, const uint32_t *pids, size_t count);
+
+/* =================================== */
+
+#endif
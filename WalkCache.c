@@ -0,0 +1,112 @@
+#include "WalkCache.h"
+
+static void clear_level(walk_cache_level *level) {
+    for (size_t i = 0; i < level->entries; i++) level->prefixes[i] = WALK_CACHE_EMPTY;
+}
+
+static bool init_level(walk_cache_level *level, size_t entries) {
+    level->entries = entries;
+    level->mask = entries - 1;
+    level->prefixes = (uint32_t*) malloc(entries * sizeof(uint32_t));
+    level->tables = (void**) malloc(entries * sizeof(void*));
+    if (!level->prefixes || !level->tables) return false;
+    clear_level(level);
+    return true;
+}
+
+// creates the page walk cache of a two or three level table with `entries` (a power of two) entries
+// per level; returns NULL for other table types or on failure
+walk_cache* init_walk_cache(tableType type, size_t entries, uint32_t second_inner_table_offset, uint32_t third_inner_table_offset) {
+    if ((type != TWO_LEVEL && type != THREE_LEVEL) || entries == 0 || (entries & (entries - 1)) != 0) return NULL;
+    walk_cache *cache = (walk_cache*) calloc(1, sizeof(walk_cache));
+    if (!cache) return NULL;
+    cache->type = type;
+    cache->second_inner_table_offset = second_inner_table_offset;
+    cache->third_inner_table_offset = third_inner_table_offset;
+    if (!init_level(&cache->leaf, entries) || (type == THREE_LEVEL && !init_level(&cache->middle, entries))) {
+        free_walk_cache(cache);
+        return NULL;
+    }
+    return cache;
+}
+
+// the low bits of the prefix pick the entry, so neighbouring tables never collide
+static inline size_t slot(const walk_cache_level *level, uint32_t prefix) {
+    return prefix & level->mask;
+}
+
+// table cached for the prefix, or NULL
+static inline void* lookup(walk_cache_level *level, uint32_t prefix) {
+    size_t i = slot(level, prefix);
+    if (level->prefixes[i] == prefix) {
+        level->hits++;
+        return level->tables[i];
+    }
+    level->misses++;
+    return NULL;
+}
+
+static inline void store(walk_cache_level *level, uint32_t prefix, void *table) {
+    size_t i = slot(level, prefix);
+    level->prefixes[i] = prefix;
+    level->tables[i] = table;
+}
+
+// walk of a two level table that missed the cache (see cached_walk_two_level); `references` gets the
+// memory references the walk made
+page_table_block* walk_two_level_miss(walk_cache *cache, page_table *table, int32_t outer_page_addr, int32_t second_inner_page_addr,
+                                      unsigned int *references) {
+    cache->leaf.misses++;
+    *references = 2;
+    page_table_block *block = get_page_two_level(table, outer_page_addr, second_inner_page_addr, cache->second_inner_table_offset);
+    store(&cache->leaf, outer_page_addr, block - second_inner_page_addr);
+    return block;
+}
+
+// walk of a three level table that missed the leaf cache (see cached_walk_three_level): a hit in the
+// second level cache still skips the outer table
+page_table_block* walk_three_level_miss(walk_cache *cache, page_table *table, int32_t outer_page_addr, int32_t second_inner_page_addr,
+                                        int32_t third_inner_page_addr, unsigned int *references) {
+    uint32_t leaf_prefix = ((uint32_t) outer_page_addr << cache->second_inner_table_offset) | second_inner_page_addr;
+    cache->leaf.misses++;
+
+    two_level_page_table *middle = (two_level_page_table*) lookup(&cache->middle, outer_page_addr);
+    page_table_block *block;
+    if (middle && middle->data[second_inner_page_addr].inner_table != NULL) {
+        *references = 2;
+        block = &((dense_page_table*) middle->data[second_inner_page_addr].inner_table->table)->data[third_inner_page_addr];
+    } else { // full walk (it also allocates the missing tables)
+        *references = middle ? 2 : 3;
+        block = get_page_three_level(table, outer_page_addr, second_inner_page_addr, third_inner_page_addr,
+                                     cache->second_inner_table_offset, cache->third_inner_table_offset);
+        three_level_page_table *outer_table = (three_level_page_table*) table->table;
+        store(&cache->middle, outer_page_addr, outer_table->data[outer_page_addr].inner_table->table);
+    }
+    store(&cache->leaf, leaf_prefix, block - third_inner_page_addr);
+    return block;
+}
+
+// drops every cached table: the walks that follow are of another page table (a context switch)
+void flush_walk_cache(walk_cache *cache) {
+    clear_level(&cache->leaf);
+    if (cache->type == THREE_LEVEL) clear_level(&cache->middle);
+}
+
+void print_walk_cache_stats(const walk_cache *cache, FILE *out) {
+    const walk_cache_level *levels[2] = { &cache->leaf, &cache->middle };
+    const char *names[2] = { "leaf tables", "second level tables" };
+    for (int l = 0; l < (cache->type == THREE_LEVEL ? 2 : 1); l++) {
+        unsigned long lookups = levels[l]->hits + levels[l]->misses;
+        fprintf(out, "Page walk cache (%s, %zu entries) hit rate: %.4f (%lu hits, %lu lookups)\n", names[l], levels[l]->entries,
+                lookups ? (double) levels[l]->hits / lookups : 0.0, levels[l]->hits, lookups);
+    }
+}
+
+void free_walk_cache(walk_cache *cache) {
+    if (cache == NULL) return;
+    free(cache->leaf.prefixes);
+    free(cache->leaf.tables);
+    free(cache->middle.prefixes);
+    free(cache->middle.tables);
+    free(cache);
+}
@@ -0,0 +1,79 @@
+#ifndef WALK_CACHE_H
+#define WALK_CACHE_H
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include "PageTable.h"
+
+#define WALK_CACHE_ENTRIES 32
+#define WALK_CACHE_EMPTY UINT32_MAX
+
+// one level of the page walk cache: a direct mapped cache from a prefix of the page number to the
+// table that prefix leads to. Inner tables are only freed with the whole page table, so a cached
+// pointer never goes stale; only a switch to another process's table flushes the cache
+typedef struct {
+    size_t entries;
+    uint32_t mask; // entries - 1
+    uint32_t *prefixes; // WALK_CACHE_EMPTY if free
+    void **tables;
+    unsigned long hits;
+    unsigned long misses;
+} walk_cache_level;
+
+// paging-structure caches of the hierarchical tables:
+//   two levels: outer index -> table of page table entries (a hit skips the outer table)
+//   three levels: outer and second index -> table of entries (skips two levels), and
+//                 outer index -> second level table (skips the outer table)
+typedef struct {
+    tableType type;
+    walk_cache_level leaf;
+    walk_cache_level middle; // three levels only
+    uint32_t second_inner_table_offset;
+    uint32_t third_inner_table_offset;
+} walk_cache;
+
+/* ============ FUNCTIONS ============ */
+
+page_table_block* walk_two_level_miss(walk_cache *cache, page_table *table, int32_t outer_page_addr, int32_t second_inner_page_addr,
+                                      unsigned int *references);
+
+page_table_block* walk_three_level_miss(walk_cache *cache, page_table *table, int32_t outer_page_addr, int32_t second_inner_page_addr,
+                                        int32_t third_inner_page_addr, unsigned int *references);
+
+// the hit path is inlined into the simulation loop: one compare and one load instead of the walk
+static inline page_table_block* cached_walk_two_level(walk_cache *cache, page_table *table, int32_t outer_page_addr,
+                                                      int32_t second_inner_page_addr, unsigned int *references) {
+    size_t i = outer_page_addr & cache->leaf.mask;
+    if (cache->leaf.prefixes[i] == (uint32_t) outer_page_addr) {
+        cache->leaf.hits++;
+        *references = 1;
+        return (page_table_block*) cache->leaf.tables[i] + second_inner_page_addr;
+    }
+    return walk_two_level_miss(cache, table, outer_page_addr, second_inner_page_addr, references);
+}
+
+static inline page_table_block* cached_walk_three_level(walk_cache *cache, page_table *table, int32_t outer_page_addr, int32_t second_inner_page_addr,
+                                                        int32_t third_inner_page_addr, unsigned int *references) {
+    uint32_t prefix = ((uint32_t) outer_page_addr << cache->second_inner_table_offset) | second_inner_page_addr;
+    size_t i = prefix & cache->leaf.mask;
+    if (cache->leaf.prefixes[i] == prefix) {
+        cache->leaf.hits++;
+        *references = 1;
+        return (page_table_block*) cache->leaf.tables[i] + third_inner_page_addr;
+    }
+    return walk_three_level_miss(cache, table, outer_page_addr, second_inner_page_addr, third_inner_page_addr, references);
+}
+
+walk_cache* init_walk_cache(tableType type, size_t entries, uint32_t second_inner_table_offset, uint32_t third_inner_table_offset);
+
+void flush_walk_cache(walk_cache *cache);
+
+void print_walk_cache_stats(const walk_cache *cache, FILE *out);
+
+void free_walk_cache(walk_cache *cache);
+
+/* =================================== */
+
+#endif
@@ -0,0 +1,179 @@
+#include "Workload.h"
+#include <pthread.h>
+#include <string.h>
+
+// the per-process simulations of a local run, handed out to the threads largest first so a long
+// process doesn't start last
+typedef struct {
+    local_process *processes;
+    size_t *order;
+    size_t count;
+    const local_config *config;
+    size_t next;
+    bool failed;
+} local_pool;
+
+// splits a multi-process trace into one trace per process, in order of their first access; returns
+// the number of processes, or 0 if memory can't be allocated (or the trace is empty)
+size_t split_by_process(const uint64_t *addresses, const char *operations, const uint32_t *pids, size_t count, local_process **processes) {
+    *processes = NULL;
+    process_table *table = init_process_table();
+    if (!table) return 0;
+
+    // first pass: the processes and how many accesses each one has
+    size_t *index = (size_t*) malloc((count ? count : 1) * sizeof(size_t));
+    for (size_t i = 0; index && i < count; i++) {
+        int p = find_process(table, pids[i]);
+        if (p == -1 && (p = add_process(table, pids[i])) == -1) {
+            free(index);
+            index = NULL;
+            break;
+        }
+        table->list[p].accesses++;
+        index[i] = p;
+    }
+    size_t processes_count = index ? table->count : 0;
+
+    local_process *list = processes_count ? (local_process*) calloc(processes_count, sizeof(local_process)) : NULL;
+    for (size_t p = 0; list && p < processes_count; p++) {
+        list[p].pid = table->list[p].pid;
+        list[p].addresses = (uint64_t*) malloc(table->list[p].accesses * sizeof(uint64_t));
+        list[p].operations = (char*) malloc(table->list[p].accesses * sizeof(char));
+        if (!list[p].addresses || !list[p].operations) {
+            free_local_processes(list, processes_count);
+            list = NULL;
+        }
+    }
+
+    // second pass: the accesses, each to its process
+    for (size_t i = 0; list && i < count; i++) {
+        local_process *local = &list[index[i]];
+        local->addresses[local->count] = addresses[i];
+        local->operations[local->count] = operations[i];
+        local->count++;
+    }
+
+    free(index);
+    free_process_table(table);
+    *processes = list;
+    return list ? processes_count : 0;
+}
+
+// divides the frames between the processes. The spec lists explicit quotas as "<pid>:<KB>,..." (it may
+// be NULL); the frames left are split evenly between the other processes, the first ones taking the
+// remainder. Returns false if the spec is malformed, asks for more than there is or leaves a process
+// without frames
+bool assign_quotas(local_process *processes, size_t count, unsigned int frames, unsigned int page_size, const char *spec) {
+    bool *fixed = (bool*) calloc(count ? count : 1, sizeof(bool));
+    unsigned long assigned = 0;
+    size_t fixed_count = 0;
+
+    while (spec && *spec) {
+        char *end;
+        unsigned long pid = strtoul(spec, &end, 10);
+        if (end == spec || *end != ':') {
+            free(fixed);
+            return false;
+        }
+        spec = end + 1;
+        unsigned long size = strtoul(spec, &end, 10);
+        if (end == spec || (*end != ',' && *end != '\0') || size < page_size) {
+            free(fixed);
+            return false;
+        }
+        spec = *end == ',' ? end + 1 : end;
+
+        for (size_t p = 0; p < count; p++) { // processes not in the trace are ignored
+            if (processes[p].pid != pid || fixed[p]) continue;
+            fixed[p] = true;
+            fixed_count++;
+            processes[p].frames = size / page_size;
+            assigned += processes[p].frames;
+        }
+    }
+
+    bool valid = assigned <= frames;
+    size_t shared_count = count - fixed_count;
+    if (valid && shared_count > 0) {
+        unsigned long left = frames - assigned;
+        valid = left >= shared_count;
+        for (size_t p = 0, k = 0; valid && p < count; p++) {
+            if (fixed[p]) continue;
+            processes[p].frames = left / shared_count + (k++ < left % shared_count ? 1 : 0);
+        }
+    }
+    free(fixed);
+    return valid;
+}
+
+static void* local_worker(void *arg) {
+    local_pool *pool = (local_pool*) arg;
+    size_t k;
+    while ((k = __atomic_fetch_add(&pool->next, 1, __ATOMIC_RELAXED)) < pool->count) {
+        local_process *local = &pool->processes[pool->order[k]];
+        const local_config *config = pool->config;
+        simulator *sim = init_simulator(config->algorithm, config->page_size, local->frames * config->page_size, config->table_type, NULL);
+        local->sim = sim;
+        if (!sim || (config->tlb && !enable_tlb(sim, config->tlb)) ||
+            (config->walk_cache_entries > 0 && !enable_walk_cache(sim, config->walk_cache_entries))) {
+            pool->failed = true;
+            continue;
+        }
+
+        size_t *next_use = NULL;
+        if (sim->replace == opt_replacement) {
+            next_use = compute_next_use(local->addresses, NULL, local->count, sim->offset, sim->address_size);
+            set_next_use(sim, next_use);
+        }
+        simulate_batch(sim, local->addresses, local->operations, local->count);
+        free(next_use);
+    }
+    return NULL;
+}
+
+// simulates every process with its quota of frames on a pool of threads; each process keeps its
+// simulation in `sim`. Returns 0, or -1 if a simulation can't be created
+int run_local(local_process *processes, size_t count, const local_config *config, int threads) {
+    local_pool pool;
+    pool.processes = processes;
+    pool.count = count;
+    pool.config = config;
+    pool.next = 0;
+    pool.failed = false;
+    pool.order = (size_t*) malloc((count ? count : 1) * sizeof(size_t));
+    if (!pool.order) return -1;
+
+    // largest first (insertion sort: there are few processes)
+    for (size_t i = 0; i < count; i++) {
+        size_t j = i;
+        while (j > 0 && processes[pool.order[j - 1]].count < processes[i].count) {
+            pool.order[j] = pool.order[j - 1];
+            j--;
+        }
+        pool.order[j] = i;
+    }
+
+    if (threads < 1) threads = 1;
+    if ((size_t) threads > count) threads = count ? count : 1;
+    pthread_t *workers = (pthread_t*) malloc(threads * sizeof(pthread_t));
+    for (int t = 0; t < threads; t++) {
+        pthread_create(&workers[t], NULL, local_worker, &pool);
+    }
+    for (int t = 0; t < threads; t++) {
+        pthread_join(workers[t], NULL);
+    }
+
+    free(workers);
+    free(pool.order);
+    return pool.failed ? -1 : 0;
+}
+
+void free_local_processes(local_process *processes, size_t count) {
+    if (processes == NULL) return;
+    for (size_t p = 0; p < count; p++) {
+        free(processes[p].addresses);
+        free(processes[p].operations);
+        free_simulator(processes[p].sim);
+    }
+    free(processes);
+}
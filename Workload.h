@@ -0,0 +1,47 @@
+#ifndef WORKLOAD_H
+#define WORKLOAD_H
+
+#include <stdio.h>
+#include <stdbool.h>
+#include "Simulator.h"
+
+// how the frames are divided between the processes of a multi-process trace
+typedef enum {
+    ALLOCATION_GLOBAL, // one pool: the victim may belong to any process (one simulation, see enable_processes)
+    ALLOCATION_LOCAL // a fixed quota per process: the victim is always the faulting process's own page
+} frameAllocation;
+
+// one process under local allocation: its accesses, its frame quota and its own simulation. With
+// fixed quotas the processes never touch each other's frames, so each one is an independent
+// simulation and they can run on different cores
+typedef struct {
+    uint32_t pid;
+    uint64_t *addresses;
+    char *operations;
+    size_t count;
+    unsigned int frames; // quota
+    simulator *sim;
+} local_process;
+
+// what every per-process simulation is made of
+typedef struct {
+    const char *algorithm;
+    unsigned int page_size; // KB
+    tableType table_type;
+    const tlb_config *tlb; // NULL: no TLB
+    size_t walk_cache_entries; // 0: no page walk cache
+} local_config;
+
+/* ============ FUNCTIONS ============ */
+
+size_t split_by_process(const uint64_t *addresses, const char *operations, const uint32_t *pids, size_t count, local_process **processes);
+
+bool assign_quotas(local_process *processes, size_t count, unsigned int frames, unsigned int page_size, const char *spec);
+
+int run_local(local_process *processes, size_t count, const local_config *config, int threads);
+
+void free_local_processes(local_process *processes, size_t count);
+
+/* =================================== */
+
+#endif
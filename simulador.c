@@ -1,340 +1,826 @@
-#include "Memory.h"
-#include "PageTable.h"
+#include "Simulator.h"
+#include "Sweep.h"
+#include "StackDistance.h"
+#include "Shards.h"
+#include "Generator.h"
+#include "Bench.h"
+#include "Profile.h"
+#include "Trace.h"
+#include "Workload.h"
 #include "utils.h"
 #include <stdio.h>
 #include <time.h>
+#include <unistd.h>
+#include <sys/resource.h>
 
 #define LOGS "logs/"
 #define MAX_PATH_LENGTH 64
-#define DEBUG_LOG "debug.log"
-#define ADDR_STR_LEN 50
+#define DEBUG_LOG "debug.bin"
+#define DEBUG_TEXT_LOG "debug.log"
+#define SIMULATION_BATCH_SIZE 4096
+
+// defaults of the generator and of the benchmark (sizes in KB)
+#define DEFAULT_ADDRESS_SPACE 262144
+#define DEFAULT_WORKING_SET 4096
+#define DEFAULT_WRITE_RATIO 0.3
+#define DEFAULT_SEED 1
+#define BENCH_ACCESSES 1000000
+#define BENCH_PAGE_SIZE 4
+#define BENCH_MEM_SIZE 1024
+
+// latencies of the effective access time (ns), changed with latency=<memory>,<tlb>,<disk>
+#define DEFAULT_MEMORY_LATENCY 100
+#define DEFAULT_TLB_LATENCY 1
+#define DEFAULT_DISK_LATENCY 5000000
+
+// path of a trace given on the command line: traces live under logs/, "-" reads stdin
+static void trace_path(char *path, size_t size, const char *name) {
+    snprintf(path, size, "%s%s", strcmp(name, "-") == 0 ? "" : LOGS, name);
+}
 
-// Função para escrever no log de debug
-void write_debug_log(FILE* debug_file, const char* message, bool debug_mode) {
-    if (debug_mode) {
-        fprintf(debug_file, "%s\n", "=============================");
-        fprintf(debug_file, "%s\n", message);
-        fprintf(debug_file, "%s\n", "=============================");
-        fflush(debug_file);
+// sweep, mrc and shards simulate a single address space: a trace with process ids would have its
+// processes merged, so it is refused. Returns true (after the message) if the trace has them
+static bool reject_process_trace(const trace_reader *trace, const char *mode) {
+    if (!trace_has_pids(trace)) return false;
+    printf("O modo %s não aceita traces com vários processos\n", mode);
+    return true;
+}
+
+// mrc, shards and the tables of types 0 to 3 split 32-bit addresses: a trace with wider ones would
+// have its pages folded together, so it is refused. Returns true (after the message) if the trace has them
+static bool reject_wide_trace(const trace_reader *trace, const char *mode) {
+    if (!trace_is_wide(trace)) return false;
+    printf("%s: endereços de 32 bits, traces com endereços de 64 bits não são aceitos\n", mode);
+    return true;
+}
+
+// translates a text trace under logs/ into the binary format: simulador convert <text trace> [binary trace]
+int convert_mode(int argc, char *argv[]) {
+    char text_path[MAX_PATH_LENGTH], binary_path[MAX_PATH_LENGTH];
+    snprintf(text_path, sizeof(text_path), "%s%s", LOGS, argv[2]);
+    if (argc > 3) {
+        snprintf(binary_path, sizeof(binary_path), "%s%s", LOGS, argv[3]);
+    } else {
+        // lru.log -> lru.bin
+        const char *dot = strrchr(argv[2], '.');
+        int name_length = dot ? (int) (dot - argv[2]) : (int) strlen(argv[2]);
+        snprintf(binary_path, sizeof(binary_path), "%s%.*s.bin", LOGS, name_length, argv[2]);
+    }
+
+    long count = convert_trace(text_path, binary_path);
+    if (count < 0) {
+        printf("Erro ao converter %s para %s\n", text_path, binary_path);
+        return 1;
+    }
+    printf("Converted %ld accesses: %s -> %s\n", count, text_path, binary_path);
+    return 0;
+}
+
+// runs a list of configurations over a trace decoded only once: simulador sweep <trace> <configurations> [threads] [csv|json]
+int sweep_mode(int argc, char *argv[]) {
+    char filepath[MAX_PATH_LENGTH];
+    trace_path(filepath, sizeof(filepath), argv[2]);
+
+    sweep_config *configs = NULL;
+    int count = read_sweep_configs(argv[3], &configs);
+    if (count <= 0) {
+        printf("Erro ao ler configurações de %s\n", argv[3]);
+        free(configs);
+        return 1;
+    }
+
+    int threads = argc > 4 ? atoi(argv[4]) : (int) sysconf(_SC_NPROCESSORS_ONLN);
+    bool json = argc > 5 && strcmp(argv[5], "json") == 0;
+
+    trace_reader *trace = open_trace(filepath);
+    if (!trace) {
+        printf("Erro ao abrir arquivo %s\n", filepath);
+        free(configs);
+        return 1;
+    }
+
+    int result = run_sweep(trace, configs, count, threads, stdout, json);
+    if (result == -2) {
+        reject_process_trace(trace, "sweep");
+    } else if (result == -3) {
+        reject_wide_trace(trace, "Modo sweep com tabelas dos tipos 0 a 3");
+    } else if (result != 0) {
+        printf("Memory allocation failed\n");
+    }
+
+    close_trace(trace);
+    free(configs);
+    return result != 0;
+}
+
+// exact LRU miss-ratio curve for every memory size in one pass: simulador mrc <trace> <page size> [max frames]
+int mrc_mode(int argc, char *argv[]) {
+    char filepath[MAX_PATH_LENGTH];
+    trace_path(filepath, sizeof(filepath), argv[2]);
+    unsigned int page_size = atoi(argv[3]);
+    unsigned long max_frames = argc > 4 ? strtoul(argv[4], NULL, 10) : 0;
+    uint32_t offset = calculateOffset(page_size << 10);
+
+    trace_reader *trace = open_trace(filepath);
+    if (!trace) {
+        printf("Erro ao abrir arquivo %s\n", filepath);
+        return 1;
+    }
+
+    stack_distance *sd = init_stack_distance((size_t) 1 << (ADDRESS_SIZE - offset));
+    uint64_t addr;
+    char rw;
+    while (!trace_has_pids(trace) && !trace_is_wide(trace) && next_access(trace, &addr, &rw)) {
+        stack_distance_access(sd, page_number((uint32_t) addr, offset)); // 32 bit address space
+    }
+    if (reject_process_trace(trace, "mrc") || reject_wide_trace(trace, "Modo mrc")) {
+        free_stack_distance(sd);
+        close_trace(trace);
+        return 1;
+    }
+    print_miss_ratio_curve(sd, stdout, page_size, max_frames);
+
+    free_stack_distance(sd);
+    close_trace(trace);
+    return 0;
+}
+
+// approximate LRU miss-ratio curve through spatial sampling:
+// simulador shards <trace> <page size> <rate> [max sampled pages] [compare]
+int shards_mode(int argc, char *argv[]) {
+    char filepath[MAX_PATH_LENGTH];
+    trace_path(filepath, sizeof(filepath), argv[2]);
+    unsigned int page_size = atoi(argv[3]);
+    double rate = atof(argv[4]);
+    size_t max_samples = argc > 5 ? strtoul(argv[5], NULL, 10) : 0;
+    bool compare = strcmp(argv[argc - 1], "compare") == 0;
+    uint32_t offset = calculateOffset(page_size << 10);
+    size_t number_of_pages = (size_t) 1 << (ADDRESS_SIZE - offset);
+
+    trace_reader *trace = open_trace(filepath);
+    if (!trace) {
+        printf("Erro ao abrir arquivo %s\n", filepath);
+        return 1;
+    }
+
+    // the exact curve is only computed to measure the sampling error
+    shards *sampler = init_shards(rate, max_samples);
+    stack_distance *exact = compare ? init_stack_distance(number_of_pages) : NULL;
+    uint64_t addr;
+    char rw;
+    while (!trace_has_pids(trace) && !trace_is_wide(trace) && next_access(trace, &addr, &rw)) {
+        uint32_t page = page_number((uint32_t) addr, offset); // 32 bit address space
+        shards_access(sampler, page);
+        if (exact) stack_distance_access(exact, page);
+    }
+    if (reject_process_trace(trace, "shards") || reject_wide_trace(trace, "Modo shards")) {
+        free_shards(sampler);
+        free_stack_distance(exact);
+        close_trace(trace);
+        return 1;
+    }
+
+    printf("# accesses: %lu, sampled references: %.0f, sampling rate: %g\n", sampler->accesses, sampler->sampled, sampler->rate);
+    printf(compare ? "frames,mem_size,miss_ratio,exact_miss_ratio\n" : "frames,mem_size,miss_ratio\n");
+
+    double total_error = 0, max_error = 0;
+    unsigned long points = 0;
+    unsigned long max_frames = shards_max_frames(sampler);
+    for (unsigned long frames = sampler->bin_width; frames <= max_frames; frames += sampler->bin_width) {
+        double ratio = shards_miss_ratio(sampler, frames);
+        if (exact) {
+            double exact_ratio = exact->accesses ? (double) stack_distance_faults(exact, frames) / exact->accesses : 0;
+            double error = ratio > exact_ratio ? ratio - exact_ratio : exact_ratio - ratio;
+            total_error += error;
+            if (error > max_error) max_error = error;
+            printf("%lu,%lu,%.6f,%.6f\n", frames, frames * page_size, ratio, exact_ratio);
+        } else {
+            printf("%lu,%lu,%.6f\n", frames, frames * page_size, ratio);
+        }
+        points++;
+    }
+    if (exact) {
+        printf("# mean absolute error: %.6f, max absolute error: %.6f\n", points ? total_error / points : 0.0, max_error);
+    }
+
+    free_shards(sampler);
+    free_stack_distance(exact);
+    close_trace(trace);
+    return 0;
+}
+
+// writes a synthetic trace under logs/ (binary if the name ends in .bin); with more than one process,
+// the trace has process ids: simulador generate <pattern> <trace> <accesses> [address space KB]
+// [working set KB] [seed] [write ratio] [processes]
+int generate_mode(int argc, char *argv[]) {
+    int pattern = get_trace_pattern(argv[2]);
+    if (pattern == -1) {
+        printf("Padrão desconhecido: %s (sequential, strided, loop, uniform, zipf ou phases)\n", argv[2]);
+        return 1;
+    }
+    char filepath[MAX_PATH_LENGTH];
+    snprintf(filepath, sizeof(filepath), "%s%s", LOGS, argv[3]);
+    size_t count = strtoul(argv[4], NULL, 10);
+
+    generator_config config;
+    config.pattern = pattern;
+    config.address_space = (argc > 5 ? strtoull(argv[5], NULL, 10) : DEFAULT_ADDRESS_SPACE) << 10;
+    config.working_set = (argc > 6 ? strtoull(argv[6], NULL, 10) : DEFAULT_WORKING_SET) << 10;
+    config.seed = argc > 7 ? strtoull(argv[7], NULL, 10) : DEFAULT_SEED;
+    config.write_ratio = argc > 8 ? atof(argv[8]) : DEFAULT_WRITE_RATIO;
+    unsigned int processes = argc > 9 ? strtoul(argv[9], NULL, 10) : 1;
+    config.stride = GENERATOR_PAGE + GENERATOR_LINE;
+    if (config.address_space > ((uint64_t) 1 << FIVE_LEVEL_ADDRESS_SIZE)) config.address_space = (uint64_t) 1 << FIVE_LEVEL_ADDRESS_SIZE;
+
+    uint64_t *addresses = (uint64_t*) malloc((count ? count : 1) * sizeof(uint64_t));
+    char *operations = (char*) malloc((count ? count : 1) * sizeof(char));
+    uint32_t *pids = NULL;
+    if (processes > 1) {
+        pids = (uint32_t*) malloc(count * sizeof(uint32_t));
+        generate_process_trace(&config, processes, addresses, operations, pids, count);
+    } else {
+        generate_trace(&config, addresses, operations, count);
+    }
+
+    const char *dot = strrchr(argv[3], '.');
+    traceFormat format = dot && strcmp(dot, ".bin") == 0 ? TRACE_BINARY : TRACE_TEXT;
+    int result = write_trace(filepath, format, addresses, operations, pids, count);
+    free(addresses);
+    free(operations);
+    free(pids);
+    if (result != 0) {
+        printf("Erro ao escrever %s\n", filepath);
+        return 1;
+    }
+    printf("Generated %zu accesses (%s): %s\n", count, trace_pattern_name(pattern), filepath);
+    return 0;
+}
+
+// runs every algorithm x table type over every synthetic pattern and writes the measurements as JSON:
+// simulador bench <output.json|-> [accesses] [page size KB] [memory size KB] [working set KB] [address space KB]
+int bench_mode(int argc, char *argv[]) {
+    bench_config config;
+    config.accesses = argc > 3 ? strtoul(argv[3], NULL, 10) : BENCH_ACCESSES;
+    config.page_size = argc > 4 ? atoi(argv[4]) : BENCH_PAGE_SIZE;
+    config.mem_size = argc > 5 ? atoi(argv[5]) : BENCH_MEM_SIZE;
+    config.working_set = (argc > 6 ? strtoull(argv[6], NULL, 10) : DEFAULT_WORKING_SET) << 10;
+    config.address_space = (argc > 7 ? strtoull(argv[7], NULL, 10) : DEFAULT_ADDRESS_SPACE) << 10;
+    config.write_ratio = DEFAULT_WRITE_RATIO;
+    config.seed = DEFAULT_SEED;
+    if (config.address_space > ((uint64_t) 1 << ADDRESS_SIZE)) config.address_space = (uint64_t) 1 << ADDRESS_SIZE;
+
+    bool to_stdout = strcmp(argv[2], "-") == 0;
+    FILE *out = to_stdout ? stdout : fopen(argv[2], "w");
+    if (!out) {
+        printf("Erro ao abrir arquivo %s\n", argv[2]);
+        return 1;
+    }
+    int result = run_benchmark(&config, out);
+    if (!to_stdout) fclose(out);
+    if (result != 0) {
+        printf("Some combinations failed, see %s\n", argv[2]);
+        return 1;
+    }
+    return 0;
+}
+
+// measures the argmin/argmax frame scans of the scan policies: simulador scanbench [max frames]
+int scanbench_mode(int argc, char *argv[]) {
+    size_t max_frames = argc > 2 ? strtoul(argv[2], NULL, 10) : SCAN_BENCH_MAX_FRAMES;
+    if (max_frames < SCAN_BENCH_MIN_FRAMES) max_frames = SCAN_BENCH_MIN_FRAMES;
+    if (run_scan_benchmark(max_frames, stdout) != 0) {
+        printf("Scan kernels disagree or memory allocation failed\n");
+        return 1;
+    }
+    return 0;
+}
+
+// renders the binary debug log as text: simulador decode [debug.bin] [debug.log]
+int decode_mode(int argc, char *argv[]) {
+    const char *binary_path = argc > 2 ? argv[2] : DEBUG_LOG;
+    const char *text_path = argc > 3 ? argv[3] : DEBUG_TEXT_LOG;
+    FILE *out = fopen(text_path, "w");
+    if (!out) {
+        printf("Erro ao abrir arquivo %s\n", text_path);
+        return 1;
+    }
+    unsigned long dropped = 0;
+    long count = decode_debug_log(binary_path, out, &dropped);
+    fclose(out);
+    if (count < 0) {
+        printf("Erro ao ler log de debug %s\n", binary_path);
+        return 1;
+    }
+    printf("Decoded %ld events: %s -> %s\n", count, binary_path, text_path);
+    if (dropped > 0) {
+        printf("Events dropped while simulating: %lu\n", dropped);
+    }
+    return 0;
+}
+
+// local allocation: the trace is split by process and every process is simulated on its own with its
+// quota of the frames, on `threads` threads. Prints the totals and one line per process
+static int run_local_allocation(const char *algorithm, const char *filename, unsigned int page_size, unsigned int mem_size,
+                                tableType table_type, const tlb_config *tlb, size_t walk_cache_entries, const char *quota_spec,
+                                int threads, const access_latency *latency) {
+    char filepath[MAX_PATH_LENGTH];
+    trace_path(filepath, sizeof(filepath), filename);
+    trace_reader *trace = open_trace(filepath);
+    if (!trace) {
+        printf("Erro ao abrir arquivo %s\n", filepath);
+        return 1;
+    }
+
+    uint64_t *addresses;
+    char *operations;
+    uint32_t *pids;
+    PROFILE_BEGIN(PHASE_PARSE);
+    size_t count = load_trace(trace, &addresses, &operations, &pids);
+    PROFILE_END(PHASE_PARSE);
+    if (table_address_size(table_type) == ADDRESS_SIZE && reject_wide_trace(trace, "Tabelas dos tipos 0 a 3 (use os tipos 4, 5 ou 6)")) {
+        free(addresses);
+        free(operations);
+        free(pids);
+        close_trace(trace);
+        return 1;
+    }
+    local_process *processes;
+    size_t process_count = split_by_process(addresses, operations, pids, count, &processes);
+    free(addresses);
+    free(operations);
+    free(pids);
+    if (process_count == 0) {
+        printf(count == 0 ? "Trace vazio: %s\n" : "Memory allocation failed\n", filepath);
+        close_trace(trace);
+        return 1;
     }
+    if (!assign_quotas(processes, process_count, mem_size / page_size, page_size, quota_spec)) {
+        printf("Cotas inválidas para %zu processos em %u frames (quota=<pid>:<KB>,...)\n", process_count, mem_size / page_size);
+        free_local_processes(processes, process_count);
+        close_trace(trace);
+        return 1;
+    }
+
+    local_config config = { algorithm, page_size, table_type, tlb, walk_cache_entries };
+    struct timespec start_time, end_time;
+    start_hardware_counters();
+    clock_gettime(CLOCK_MONOTONIC, &start_time);
+    int result = run_local(processes, process_count, &config, threads);
+    clock_gettime(CLOCK_MONOTONIC, &end_time);
+    stop_hardware_counters();
+    if (result != 0) {
+        printf("Memory allocation failed\n");
+        free_local_processes(processes, process_count);
+        close_trace(trace);
+        return 1;
+    }
+    double elapsed = (end_time.tv_sec - start_time.tv_sec) + (end_time.tv_nsec - start_time.tv_nsec) / 1e9;
+
+    // the processes add up as one simulation for the totals
+    simulator totals;
+    memset(&totals, 0, sizeof(totals));
+    totals.tlb = processes[0].sim->tlb;
+    page_table_usage usage = { 0, 0, 0 };
+    for (size_t p = 0; p < process_count; p++) {
+        simulator *sim = processes[p].sim;
+        totals.total_accesses += sim->total_accesses;
+        totals.mem_access += sim->mem_access;
+        totals.page_faults += sim->page_faults;
+        totals.faults += sim->faults;
+        totals.dirty_pages += sim->dirty_pages;
+        totals.walk_accesses += sim->walk_accesses;
+        totals.tlb_saved += sim->tlb_saved;
+        page_table_usage process_usage;
+        get_page_table_usage(sim->page_table, &process_usage);
+        usage.nodes += process_usage.nodes;
+        usage.allocations += process_usage.allocations;
+        usage.bytes += process_usage.bytes;
+    }
+
+    printf("Algorithm: %s\n", algorithm);
+    printf("Filename: %s\n", filename);
+    printf("Page size: %d\n", page_size);
+    printf("Memory size: %d\n", mem_size);
+    printf("Memory accesses: %d\n", totals.mem_access);
+    printf("Page faults: %d\n", totals.page_faults);
+    printf("Dirty pages: %d\n", totals.dirty_pages);
+    printf("Processes: %zu (local replacement, %d threads)\n", process_count, threads < (int) process_count ? threads : (int) process_count);
+    for (size_t p = 0; p < process_count; p++) {
+        simulator *sim = processes[p].sim;
+        printf("Process %u: accesses %lu, frames %u, page faults %lu, dirty pages %u\n",
+               processes[p].pid, sim->total_accesses, processes[p].frames, sim->faults, sim->dirty_pages);
+    }
+    if (totals.tlb) {
+        printf("Adjusted memory accesses: %lu\n", adjusted_memory_accesses(&totals));
+    }
+    printf("Page table references: %lu\n", totals.walk_accesses);
+    printf("Effective access time: %.2f ns (memory %g ns, TLB %g ns, disk %g ns)\n",
+           effective_access_time(&totals, latency), latency->memory, latency->tlb, latency->disk);
+    struct rusage rusage;
+    getrusage(RUSAGE_SELF, &rusage);
+    printf("Page table nodes: %zu\n", usage.nodes);
+    printf("Page table allocations: %zu\n", usage.allocations);
+    printf("Page table bytes: %zu\n", usage.bytes);
+    printf("Peak RSS: %ld KB\n", rusage.ru_maxrss);
+    printf("Trace format: %s\n", trace->format == TRACE_BINARY ? "binary" : "text");
+    printf("Throughput: %.0f accesses/sec\n", elapsed > 0 ? totals.total_accesses / elapsed : 0.0);
+
+    free_local_processes(processes, process_count);
+    close_trace(trace);
+    return 0;
 }
 
-int access_counter = 0; // used in lru aglorithm (global variable)
+// frames used by a simulation with dynamic allocation: the policy, the frames it granted and gave back,
+// the peak and average memory and samples of the frames in use over the run
+static void print_allocation(simulator *sim) {
+    frame_allocation *allocation = sim->allocation;
+    if (allocation->config.policy == ALLOCATION_PFF) {
+        printf("Frame allocation: pff (fault rate %g to %g)\n", allocation->config.lower, allocation->config.upper);
+        printf("Frames granted: %lu, reclaimed: %lu, released: %lu\n", allocation->grants, allocation->reclaims, allocation->releases);
+    } else {
+        printf("Frame allocation: working set (tau %lu)\n", allocation->config.tau);
+        printf("Frames released: %lu\n", allocation->releases);
+    }
+    double average = average_frames(allocation, sim->total_accesses);
+    printf("Peak memory: %u frames (%lu KB)\n", allocation->peak_resident, (unsigned long) allocation->peak_resident * sim->page_size);
+    printf("Average memory: %.1f frames (%.0f KB)\n", average, average * sim->page_size);
+    printf("Frames over time (accesses:frames):");
+    for (size_t i = 0; i < allocation->history_length; i++) {
+        printf(" %lu:%u", allocation->history_time[i], allocation->history_value[i]);
+    }
+    printf(" %lu:%u\n", sim->total_accesses, allocation->resident);
+}
+
+// one line per process of a multi-process simulation under global replacement
+static void print_processes(const simulator *sim) {
+    printf("Processes: %zu (global replacement)\n", sim->processes->count);
+    for (size_t i = 0; i < sim->processes->count; i++) {
+        const process *p = &sim->processes->list[i];
+        printf("Process %u: accesses %lu, page faults %u, dirty pages %u, resident frames %u (peak %u)\n",
+               p->pid, p->accesses, p->page_faults, p->dirty_pages, p->resident, p->peak_resident);
+    }
+}
 
 int main(int argc, char *argv[]) {
     bool debug_mode = false;
+    debugPolicy debug_policy = DEBUG_BLOCK;
+
+    if (argc >= 3 && strcmp(argv[1], "convert") == 0) {
+        return convert_mode(argc, argv);
+    }
+    if (argc >= 4 && strcmp(argv[1], "sweep") == 0) {
+        return sweep_mode(argc, argv);
+    }
+    if (argc >= 4 && strcmp(argv[1], "mrc") == 0) {
+        return mrc_mode(argc, argv);
+    }
+    if (argc >= 5 && strcmp(argv[1], "shards") == 0) {
+        return shards_mode(argc, argv);
+    }
+    if (argc >= 5 && strcmp(argv[1], "generate") == 0) {
+        return generate_mode(argc, argv);
+    }
+    if (argc >= 3 && strcmp(argv[1], "bench") == 0) {
+        return bench_mode(argc, argv);
+    }
+    if (argc >= 2 && strcmp(argv[1], "scanbench") == 0) {
+        return scanbench_mode(argc, argv);
+    }
+    if (argc >= 2 && strcmp(argv[1], "decode") == 0) {
+        return decode_mode(argc, argv);
+    }
 
-    // Verifica se há argumento debug
-    if (argc == 7 && strcmp(argv[6], "debug") == 0) {
-        debug_mode = true;
-    } else if (argc < 6) {
+    if (argc < 6) {
         printf("Insuficient number of arguments");
         return 1;
     }
 
+    // Verifica se há argumento debug ou tlb
+    // debug waits for the log writer when its buffer is full; debug:drop drops (and counts) the events instead;
+    // tlb[=<description>] puts a TLB in front of the page table (see parse_tlb_config); pwc[=<entries>]
+    // adds a page walk cache to two and three level tables; latency=<memory>,<tlb>,<disk> sets the
+    // latencies (ns) of the effective access time; procs=global|local[:<threads>] chooses how the frames are
+    // divided between the processes of a multi-process trace (global by default if the trace has process
+    // ids) and quota=<pid>:<KB>,... sets quotas of local allocation; metrics=<file>[,<interval>[,<tau>]]
+    // streams windowed metrics (see Metrics.h); alloc=pff[:<lower>,<upper>]|ws[:<tau>] lets the frames in use
+    // grow and shrink (see Allocation.h)
+    bool tlb_mode = false;
+    bool allocation_given = false;
+    frameAllocation allocation = ALLOCATION_GLOBAL;
+    int local_threads = (int) sysconf(_SC_NPROCESSORS_ONLN);
+    const char *quota_spec = NULL;
+    tlb_config tlb_description;
+    size_t walk_cache_entries = 0;
+    access_latency latency = { DEFAULT_MEMORY_LATENCY, DEFAULT_TLB_LATENCY, DEFAULT_DISK_LATENCY };
+    bool allocation_mode = false;
+    allocation_config allocation_description;
+    char metrics_path[MAX_PATH_LENGTH] = "";
+    unsigned long metrics_interval = METRICS_INTERVAL;
+    unsigned long metrics_tau = 0;
+    for (int i = 6; i < argc; i++) {
+        if (strcmp(argv[i], "debug") == 0 || strcmp(argv[i], "debug:block") == 0 || strcmp(argv[i], "debug:drop") == 0) {
+            debug_mode = true;
+            debug_policy = strcmp(argv[i], "debug:drop") == 0 ? DEBUG_DROP : DEBUG_BLOCK;
+        } else if (strcmp(argv[i], "tlb") == 0 || strncmp(argv[i], "tlb=", 4) == 0) {
+            if (!parse_tlb_config(argv[i][3] == '=' ? argv[i] + 4 : "", &tlb_description)) {
+                printf("Configuração de TLB inválida: %s\n", argv[i]);
+                return 1;
+            }
+            tlb_mode = true;
+        } else if (strcmp(argv[i], "pwc") == 0 || strncmp(argv[i], "pwc=", 4) == 0) {
+            walk_cache_entries = argv[i][3] == '=' ? strtoul(argv[i] + 4, NULL, 10) : WALK_CACHE_ENTRIES;
+        } else if (strcmp(argv[i], "procs=global") == 0) {
+            allocation_given = true;
+            allocation = ALLOCATION_GLOBAL;
+        } else if (strcmp(argv[i], "procs=local") == 0 || strncmp(argv[i], "procs=local:", 12) == 0) {
+            allocation_given = true;
+            allocation = ALLOCATION_LOCAL;
+            if (argv[i][11] == ':') local_threads = atoi(argv[i] + 12);
+            if (local_threads < 1) local_threads = 1;
+        } else if (strncmp(argv[i], "quota=", 6) == 0) {
+            quota_spec = argv[i] + 6;
+        } else if (strncmp(argv[i], "alloc=", 6) == 0) {
+            if (!parse_allocation_config(argv[i] + 6, &allocation_description)) {
+                printf("Alocação dinâmica inválida: %s (alloc=pff[:<inferior>,<superior>] ou alloc=ws[:<τ>])\n", argv[i]);
+                return 1;
+            }
+            allocation_mode = true;
+        } else if (strncmp(argv[i], "metrics=", 8) == 0) {
+            size_t length = strcspn(argv[i] + 8, ",");
+            if (length == 0 || length >= sizeof(metrics_path)) {
+                printf("Arquivo de métricas inválido: %s\n", argv[i]);
+                return 1;
+            }
+            memcpy(metrics_path, argv[i] + 8, length);
+            metrics_path[length] = '\0';
+            const char *rest = argv[i] + 8 + length;
+            if (*rest == ',') {
+                char *end;
+                metrics_interval = strtoul(rest + 1, &end, 10);
+                if (*end == ',') metrics_tau = strtoul(end + 1, NULL, 10);
+            }
+            if (metrics_tau == 0) metrics_tau = metrics_interval;
+        } else if (strncmp(argv[i], "latency=", 8) == 0) {
+            if (sscanf(argv[i] + 8, "%lf,%lf,%lf", &latency.memory, &latency.tlb, &latency.disk) != 3) {
+                printf("Latências inválidas: %s (latency=<memória>,<tlb>,<disco> em ns)\n", argv[i]);
+                return 1;
+            }
+        } else {
+            printf("Argumento desconhecido: %s\n", argv[i]);
+            return 1;
+        }
+    }
+
     // arguments
     char *algorithm = argv[1];
     char *filename = argv[2];
     unsigned int page_size = atoi(argv[3]);
     unsigned int mem_size = atoi(argv[4]);
     int table_type = atoi(argv[5]);
+    if (table_type < DENSE_PAGE_TABLE || table_type > HASHED) {
+        printf("Tipo de tabela desconhecido: %s (0 a 6)\n", argv[5]);
+        return 1;
+    }
 
-    // Abre arquivo de debug se necessário
-    FILE* debug_file = NULL;
+    if (allocation == ALLOCATION_LOCAL) {
+        if (debug_mode || metrics_path[0] || allocation_mode) {
+            printf("Os modos debug, metrics e alloc não são suportados com procs=local\n");
+            return 1;
+        }
+        if (get_replacement_function(algorithm) == NULL) {
+            printf("Algoritmo desconhecido: %s\n", algorithm);
+            return 1;
+        }
+        if (walk_cache_entries > 0 && ((table_type != TWO_LEVEL && table_type != THREE_LEVEL) || (walk_cache_entries & (walk_cache_entries - 1)) != 0)) {
+            printf("Page walk cache indisponível: só para tabelas de dois ou três níveis, com um número de entradas potência de 2\n");
+            return 1;
+        }
+        return run_local_allocation(algorithm, filename, page_size, mem_size, table_type, tlb_mode ? &tlb_description : NULL,
+                                    walk_cache_entries, quota_spec, local_threads, &latency);
+    }
+
+    // Abre arquivo de debug se necessário (binário; `simulador decode` gera o texto)
+    debug_log *debug = NULL;
     if (debug_mode) {
-        debug_file = fopen(DEBUG_LOG, "w");
-        if (!debug_file) {
+        debug = open_debug_log(DEBUG_LOG, debug_policy);
+        if (!debug) {
             printf("Erro ao abrir arquivo de debug\n");
             debug_mode = false;
         } else {
-            write_debug_log(debug_file, "Iniciando simulação de acessos à memória", true);
+            debug_event(debug, DEBUG_START, 0, 0, 0, 0);
         }
     }
 
-    // variables to be used all over the program
-    unsigned int dirty_pages = 0;
-    unsigned int page_faults = 0;
-    uint32_t offset = calculateOffset(page_size << 10);
-    uint32_t second_inner_table_offset, third_inner_table_offset, outer_table_offset;
-    int32_t second_inner_page_addr, third_inner_page_addr, outer_page_addr;
-    unsigned int total_physical_frames = mem_size / page_size;
-    unsigned int number_of_pages;
-
-    set_tables_offset(table_type, offset, &outer_table_offset, &second_inner_table_offset, &third_inner_table_offset);
-
-    if(table_type == INVERTED){
-        number_of_pages = total_physical_frames;
-    } else {
-        number_of_pages = pow(2, outer_table_offset);
+    if (get_replacement_function(algorithm) == NULL) {
+        printf("Algoritmo desconhecido: %s\n", algorithm);
+        close_debug_log(debug);
+        return 1;
     }
 
-    // initialize page table and memory
-    page_table* page_table = init_page_table(number_of_pages, table_type);
-    physical_frame *memory = init_memory(total_physical_frames);
+    // initialize page table, memory and replacement structures
+    simulator *sim = init_simulator(algorithm, page_size, mem_size, table_type, debug);
+    if (!sim) {
+        printf("Memory allocation failed\n");
+        close_debug_log(debug);
+        return 1;
+    }
 
-    if (!page_table || !memory) {
+    if (tlb_mode && !enable_tlb(sim, &tlb_description)) {
         printf("Memory allocation failed\n");
-        free(page_table);
-        free(memory);
-        if (debug_file) fclose(debug_file);
+        free_simulator(sim);
+        close_debug_log(debug);
+        return 1;
+    }
+    if (walk_cache_entries > 0 && !enable_walk_cache(sim, walk_cache_entries)) {
+        printf("Page walk cache indisponível: só para tabelas de dois ou três níveis, com um número de entradas potência de 2\n");
+        free_simulator(sim);
+        close_debug_log(debug);
         return 1;
     }
 
-    char filepath[MAX_PATH_LENGTH];
-    snprintf(filepath, sizeof(filepath), "%s%s", LOGS, filename);
+    if (allocation_mode && !enable_dynamic_allocation(sim, &allocation_description)) {
+        printf("Alocação dinâmica indisponível para %s (não suportada por lru:scan, lfu:scan, mfu:scan, arc, 2q e lirs)\n", algorithm);
+        free_simulator(sim);
+        close_debug_log(debug);
+        return 1;
+    }
 
-    uint32_t addr;
-    char rw;
-    FILE *file = fopen(filepath, "r");
-    int mem_access = 0;
-
-    while (fscanf(file, "%x %c", &addr, &rw) != EOF) {
-        if (debug_mode) {
-            char log_msg[256];
-            snprintf(log_msg, sizeof(log_msg), "Processando acesso: endereço=0x%x, operação=%c", addr, rw);
-            write_debug_log(debug_file, log_msg, true);
+    // windows of `metrics_interval` accesses, working set over the last `metrics_tau` references
+    metrics_stream *metrics = NULL;
+    if (metrics_path[0]) {
+        metrics = open_metrics(metrics_path, metrics_interval, metrics_tau);
+        if (!metrics) {
+            printf("Erro ao abrir arquivo de métricas %s (intervalo de 1 a %u acessos, τ de 1 a %lu)\n", metrics_path, UINT32_MAX, METRICS_MAX_TAU);
+            free_simulator(sim);
+            close_debug_log(debug);
+            return 1;
         }
+        set_metrics(sim, metrics);
+    }
 
-        /* ============= Set each page address according to the table type ============= */
-        switch (table_type) {
-            case DENSE_PAGE_TABLE:
-                third_inner_page_addr = -1;
-                second_inner_page_addr = -1;
-                outer_page_addr = addr >> offset;
-                mem_access++;
-                break;
-            case TWO_LEVEL:
-                third_inner_page_addr = -1;
-                second_inner_page_addr = (addr >> offset) & make_mask(second_inner_table_offset);
-                outer_page_addr = (addr >> (offset + second_inner_table_offset)) & make_mask(outer_table_offset);
-                mem_access += 2;
-                break;
-            case THREE_LEVEL:
-                third_inner_page_addr = (addr >> offset) & make_mask(third_inner_table_offset);
-                second_inner_page_addr = (addr >> (offset + third_inner_table_offset)) & make_mask(second_inner_table_offset);
-                outer_page_addr = (addr >> (offset + second_inner_table_offset + third_inner_table_offset)) & make_mask(outer_table_offset);
-                mem_access += 3;
-                break;
-            case INVERTED:
-                third_inner_page_addr = -1;
-                second_inner_page_addr = -1;
-                outer_page_addr = addr >> offset;
-                mem_access++;
-                break;
+    char filepath[MAX_PATH_LENGTH];
+    trace_path(filepath, sizeof(filepath), filename);
+
+    trace_reader *trace = open_trace(filepath); // text traces or binary traces (read through mmap)
+    if (!trace) {
+        printf("Erro ao abrir arquivo %s\n", filepath);
+        free_simulator(sim);
+        close_metrics(metrics);
+        close_debug_log(debug);
+        return 1;
+    }
+    // accesses are decoded in batches and handed to the simulation kernel chosen for the table type.
+    // A trace with process ids (or procs=global) is simulated as several processes sharing the frames
+    uint64_t *addresses;
+    char *operations;
+    uint32_t *pids;
+    size_t count;
+    struct timespec start_time, end_time;
+    bool processes_ok = true;
+    bool addresses_ok = true; // tables of types 0 to 3 can't take a trace with 64-bit addresses
+
+    if (sim->replace == opt_replacement) {
+        // opt needs to know the future: the trace is loaded once, the reverse pre-pass computes the
+        // next use of every access and the simulation runs over the same arrays
+        PROFILE_BEGIN(PHASE_PARSE);
+        count = load_trace(trace, &addresses, &operations, &pids);
+        PROFILE_END(PHASE_PARSE);
+        if (sim->address_size == ADDRESS_SIZE && trace_is_wide(trace)) {
+            addresses_ok = false;
+            count = 0; // nothing is simulated
         }
-        /* ============================================================================= */
-
-        if(table_type == INVERTED){
-            inverted_page_table* table_ptr = (inverted_page_table*) page_table->table; // instantiate the table to its correct type
-            inverted_page_table_block* block_ptr = NULL; // this variable will keep the associated entry
-            int free_block_index = -1;
-            bool page_found = false;
-
-            if (debug_mode) {
-                char log_msg[256];
-                snprintf(log_msg, sizeof(log_msg), "Procurando página %u na tabela invertida", outer_page_addr);
-                write_debug_log(debug_file, log_msg, true);
-            }
-
-            // searches for the page or for a free block
-            for (size_t i = 0; i < page_table->table_size; i++) {
-                if(table_ptr->data[i].page == outer_page_addr){
-                    block_ptr = &table_ptr->data[i];
-                    page_found = true;
-                    if (debug_mode) {
-                        char log_msg[256];
-                        snprintf(log_msg, sizeof(log_msg), "Página encontrada no frame %zu", i);
-                        write_debug_log(debug_file, log_msg, true);
-                    }
-                    break;
-                } else if (block_ptr == NULL && table_ptr->data[i].page == -1) {
-                    block_ptr = &table_ptr->data[i];
-                    free_block_index = i;
-                    if (debug_mode) {
-                        char log_msg[256];
-                        snprintf(log_msg, sizeof(log_msg), "Página não encontrada. Espaço livre no frame %zu", i);
-                        write_debug_log(debug_file, log_msg, true);
-                    }
-                }
+        if ((allocation_given || trace_has_pids(trace)) && !enable_processes(sim)) processes_ok = false;
+        start_hardware_counters();
+        clock_gettime(CLOCK_MONOTONIC, &start_time);
+        size_t *next_use = compute_next_use(addresses, sim->processes ? pids : NULL, count, sim->offset, sim->address_size);
+        set_next_use(sim, next_use);
+        if (sim->processes) {
+            processes_ok = processes_ok && simulate_processes(sim, addresses, operations, pids, count);
+        } else {
+            simulate_batch(sim, addresses, operations, count);
+        }
+        clock_gettime(CLOCK_MONOTONIC, &end_time);
+        stop_hardware_counters();
+        free(next_use);
+    } else {
+        addresses = (uint64_t*) malloc(SIMULATION_BATCH_SIZE * sizeof(uint64_t));
+        operations = (char*) malloc(SIMULATION_BATCH_SIZE * sizeof(char));
+        pids = (uint32_t*) malloc(SIMULATION_BATCH_SIZE * sizeof(uint32_t));
+        start_hardware_counters();
+        clock_gettime(CLOCK_MONOTONIC, &start_time);
+        do {
+            PROFILE_BEGIN(PHASE_PARSE);
+            count = next_process_accesses(trace, addresses, operations, pids, SIMULATION_BATCH_SIZE);
+            PROFILE_END(PHASE_PARSE);
+            if (sim->address_size == ADDRESS_SIZE && trace_is_wide(trace)) {
+                addresses_ok = false;
+                break;
             }
-
-            if(page_found){ // page is in memory
-                if (debug_mode) {
-                    write_debug_log(debug_file, "Hit na tabela invertida - atualizando dados de acesso", true);
-                }
-
-                // Hit: update access moment, modified bit & access counter
-                (*block_ptr).last_access_moment = ++access_counter;
-                (*block_ptr).access_counter++;
-                if(rw == 'W'){
-                    (*block_ptr).modified = true;
-                }
-
-                // update the frame attributes
-                memory[(*block_ptr).frame].last_access_moment = ++access_counter;
-                memory[(*block_ptr).frame].access_counter++;
-                if(rw == 'W'){
-                    memory[(*block_ptr).frame].modified = true;
-                }
-            } else if(!page_found && free_block_index != -1){ // page was not found but there is a free block
-                page_faults++;
-                mem_access++;
-
-                if (debug_mode) {
-                    char log_msg[256];
-                    snprintf(log_msg, sizeof(log_msg), "Page fault - alocando página %u no frame livre %d", outer_page_addr, free_block_index);
-                    write_debug_log(debug_file, log_msg, true);
-                }
-
-                // change the page associated to the block and its other attributes
-                table_ptr->data[free_block_index].page = outer_page_addr;
-                table_ptr->data[free_block_index].modified = rw == 'W';
-                (*block_ptr).last_access_moment = ++access_counter;
-                (*block_ptr).access_counter = 1;
-                (*block_ptr).frame = free_block_index;
-
-                // update the frame attributes
-                memory[free_block_index].modified = rw == 'W';
-                memory[free_block_index].last_access_moment = ++access_counter;
-                memory[free_block_index].access_counter = 1;
-
-            } else { // page was not found and there is not a free block
-                if (debug_mode) {
-                    write_debug_log(debug_file, "Page fault - chamando algoritmo de substituição", true);
-                }
-
-                // call replacement algorithm
-                int index_to_replace = replace_inverted_page_table_entry(algorithm, table_ptr, page_table->table_size);
-
-                if (debug_mode) {
-                    char log_msg[256];
-                    snprintf(log_msg, sizeof(log_msg), "Algoritmo selecionou frame %d para substituição", index_to_replace);
-                    write_debug_log(debug_file, log_msg, true);
-                }
-
-                if (table_ptr->data[index_to_replace].modified) { // page was modified and need to be written on the disk
-                    dirty_pages++;
-                    if (debug_mode) {
-                        write_debug_log(debug_file, "Página substituída estava modificada (dirty)", true);
-                    }
-                }
-                table_ptr->data[index_to_replace].page = outer_page_addr; // replace the page
-
-                // update the block attributes
-                table_ptr->data[index_to_replace].last_access_moment = ++access_counter;
-                table_ptr->data[index_to_replace].access_counter = 1;
-                table_ptr->data[index_to_replace].modified = rw == 'W';
-
-                // update the frame attributes
-                memory[index_to_replace].modified = (rw == 'W');
-                memory[index_to_replace].last_access_moment = ++access_counter;
-                memory[index_to_replace].access_counter = 1;
-
-                mem_access++;
+            // the pids of a text trace may start after the first chunks: checked on every batch
+            if (!sim->processes && (allocation_given || trace_has_pids(trace)) && !enable_processes(sim)) {
+                processes_ok = false;
+                break;
             }
-        } else {
-            page_table_block* block = get_page(page_table, outer_page_addr, second_inner_page_addr, third_inner_page_addr, second_inner_table_offset, third_inner_table_offset);
-
-            if (!(*block).valid) { // page was not yet brought to memory
-                page_faults++;
-                mem_access++;
-
-                if (debug_mode) {
-                    char log_msg[256];
-                    snprintf(log_msg, sizeof(log_msg), "Page fault - página %u-%u-%u não está na memória", outer_page_addr, second_inner_page_addr, third_inner_page_addr);
-                    write_debug_log(debug_file, log_msg, true);
-                }
-
-                int ff_index = find_free_frame(memory, total_physical_frames);
-                if (ff_index == -1) { // there is not a single free memory frame
-
-                    if (debug_mode) {
-                        write_debug_log(debug_file, "Memória cheia - chamando algoritmo de substituição", true);
-                    }
-
-                    // call page replacement algorithm
-                    unsigned int mem_frame_to_replace = frame_to_be_replaced(algorithm, memory, total_physical_frames);
-
-                    if (debug_mode) {
-                        char log_msg[256];
-                        snprintf(log_msg, sizeof(log_msg), "Algoritmo selecionou frame %u para substituição", mem_frame_to_replace);
-                        write_debug_log(debug_file, log_msg, true);
-                    }
-
-                    if (memory[mem_frame_to_replace].modified) { // page was modified and need to be written on the disk
-                        dirty_pages++;
-                        if (debug_mode) {
-                            write_debug_log(debug_file, "Página substituída estava modificada (dirty)", true);
-                        }
-                    }
-
-                    memory[mem_frame_to_replace].virtual_page->valid = false; // make the old page allocated invalid
-                    memory[mem_frame_to_replace].virtual_page->frame = -1; // make the frame reference to the old page allocated invalid
-                    memory[mem_frame_to_replace].virtual_page = block; // allocate the new page
-
-                    // update the frame attributes
-                    memory[mem_frame_to_replace].modified = (rw == 'W');
-                    memory[mem_frame_to_replace].last_access_moment = ++access_counter;
-                    memory[mem_frame_to_replace].access_counter = 1;
-
-                    (*block).frame = mem_frame_to_replace; // make the reference to the new frame where the page is allocated
-                } else {
-                    mem_access++;
-                    if (debug_mode) {
-                        char log_msg[256];
-                        snprintf(log_msg, sizeof(log_msg), "Alocando página no frame livre %d", ff_index);
-                        write_debug_log(debug_file, log_msg, true);
-                    }
-
-                    // update the frame attributes
-                    memory[ff_index].allocated = true;
-                    memory[ff_index].virtual_page = block;
-                    memory[ff_index].modified = rw == 'W';
-                    memory[ff_index].last_access_moment = ++access_counter;
-                    memory[ff_index].access_counter = 1;
-
-                    // update the block frame reference
-                    (*block).frame = ff_index;
-                }
-
-                // block was brought into memory
-                (*block).valid = true;
+            if (sim->processes) {
+                if (!(processes_ok = simulate_processes(sim, addresses, operations, pids, count))) break;
             } else {
-                if (debug_mode) {
-                    char log_msg[256];
-                    snprintf(log_msg, sizeof(log_msg), "Hit - página %u-%u-%u encontrada no frame %d", outer_page_addr, second_inner_page_addr, third_inner_table_offset, (*block).frame);
-                    write_debug_log(debug_file, log_msg, true);
-                }
-
-                // hit: update access moment, modified bit & number of accesses
-                memory[(*block).frame].last_access_moment = ++access_counter;
-                memory[(*block).frame].access_counter++;
-                if(rw == 'W'){
-                    memory[(*block).frame].modified = true;
-                }
+                simulate_batch(sim, addresses, operations, count);
             }
+        } while (count == SIMULATION_BATCH_SIZE);
+        clock_gettime(CLOCK_MONOTONIC, &end_time);
+        stop_hardware_counters();
+    }
+    free(addresses);
+    free(operations);
+    free(pids);
+    if (!processes_ok || !addresses_ok) {
+        if (!addresses_ok) {
+            reject_wide_trace(trace, "Tabelas dos tipos 0 a 3 (use os tipos 4, 5 ou 6)");
+        } else {
+            printf("Memory allocation failed (or more than %d processes)\n", PROCESS_MAX);
         }
+        close_trace(trace);
+        free_simulator(sim);
+        close_metrics(metrics);
+        close_debug_log(debug);
+        return 1;
     }
+    double elapsed = (end_time.tv_sec - start_time.tv_sec) + (end_time.tv_nsec - start_time.tv_nsec) / 1e9;
+    finish_metrics(sim);
 
     printf("Algorithm: %s\n", algorithm);
     printf("Filename: %s\n", filename);
     printf("Page size: %d\n", page_size);
     printf("Memory size: %d\n", mem_size);
-    printf("Memory accesses: %d\n", mem_access);
-    printf("Page faults: %d\n", page_faults);
-    printf("Dirty pages: %d\n", dirty_pages);
+    printf("Memory accesses: %d\n", sim->mem_access);
+    printf("Page faults: %d\n", sim->page_faults);
+    printf("Dirty pages: %d\n", sim->dirty_pages);
+    if (sim->processes) {
+        print_processes(sim);
+    }
+    if (sim->allocation) {
+        print_allocation(sim);
+    }
+    if (table_type == INVERTED) {
+        inverted_page_table* table_ptr = (inverted_page_table*) sim->page_table->table;
+        printf("Hash lookups: %lu\n", table_ptr->hash_lookups);
+        printf("Hash probes per lookup: %.3f\n", table_ptr->hash_lookups ? (double) table_ptr->hash_probes / table_ptr->hash_lookups : 0.0);
+    } else if (table_type == HASHED) {
+        hashed_page_table* table_ptr = (hashed_page_table*) sim->page_table->table;
+        printf("Hash lookups: %lu\n", table_ptr->lookups);
+        printf("Hash probes per lookup: %.3f\n", table_ptr->lookups ? (double) table_ptr->probes / table_ptr->lookups : 0.0);
+    }
+    if (sim->tlb) {
+        print_tlb_stats(sim->tlb, stdout);
+        printf("Adjusted memory accesses: %lu\n", adjusted_memory_accesses(sim));
+    }
+    if (sim->walk_cache) {
+        print_walk_cache_stats(sim->walk_cache, stdout);
+    }
+    printf("Page table references: %lu\n", sim->walk_accesses);
+    printf("Effective access time: %.2f ns (memory %g ns, TLB %g ns, disk %g ns)\n",
+           effective_access_time(sim, &latency), latency.memory, latency.tlb, latency.disk);
+    if (sim->replace == clock_replacement || sim->replace == second_chance_replacement || sim->replace == wsclock_replacement) {
+        printf("Clock hand steps: %lu\n", sim->clock->steps);
+    }
+    if (sim->adaptive) {
+        adaptive_cache *cache = sim->adaptive;
+        printf("Adaptive parameter (%s): %.2f\n", adaptive_parameter_name(cache), adaptive_parameter(cache));
+        printf("Adaptive parameter over time (accesses:value):");
+        for (size_t i = 0; i < cache->history_length; i++) {
+            printf(" %lu:%.2f", cache->history_time[i], cache->history_value[i]);
+        }
+        printf("\n");
+    }
+    page_table_usage usage;
+    get_simulator_page_table_usage(sim, &usage);
+    struct rusage rusage;
+    getrusage(RUSAGE_SELF, &rusage);
+    printf("Page table nodes: %zu\n", usage.nodes);
+    printf("Page table allocations: %zu\n", usage.allocations);
+    printf("Page table bytes: %zu\n", usage.bytes);
+    printf("Peak RSS: %ld KB\n", rusage.ru_maxrss);
+    printf("Trace format: %s\n", trace->format == TRACE_BINARY ? "binary" : "text");
+    printf("Throughput: %.0f accesses/sec\n", elapsed > 0 ? sim->total_accesses / elapsed : 0.0);
+    print_profile(stdout, sim->total_accesses);
 
     if (debug_mode) {
-        char log_msg[256];
-        snprintf(log_msg, sizeof(log_msg), "Simulação concluída. Acessos: %d, Page Faults: %d, Dirty Pages: %d", mem_access, page_faults, dirty_pages);
-        write_debug_log(debug_file, log_msg, true);
-        fclose(debug_file);
+        debug_event(debug, DEBUG_END, sim->mem_access, sim->page_faults, sim->dirty_pages, 0);
+        if (debug->dropped > 0) {
+            printf("Debug events dropped: %lu\n", debug->dropped);
+        }
+        if (close_debug_log(debug) != 0) {
+            printf("Erro ao escrever arquivo de debug\n");
+        }
+    }
+
+    if (metrics && close_metrics(metrics) != 0) {
+        printf("Erro ao escrever arquivo de métricas\n");
     }
 
     // free allocated memory
-    fclose(file);
-    free_page_table(page_table, table_type);
-    free(memory);
+    close_trace(trace);
+    free_simulator(sim);
 
     return 0;
 }
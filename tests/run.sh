@@ -0,0 +1,399 @@
+#!/bin/sh
+# checks that the fast paths agree with the reference ones: make test
+#   - the stack distance curve (mrc) has the page faults of lru at every memory size
+#   - lru:scan, lfu:scan and mfu:scan have the results of lru, lfu and mfu on every table type
+#   - a text trace converted to the binary format gives the same simulation
+#   - the process ids of a text trace survive the conversion
+#   - the binary debug log decodes to the text log of the original simulator, byte for byte
+#   - pids that show up only after the first chunks of a text trace are not lost
+#   - traces with 64-bit addresses are refused by mrc, shards and the tables of 32-bit addresses
+#   - a refused trace read from a pipe does not wait for the pipe to be closed
+#   - shards at rate 1, with every page sampled, has the exact curve
+#   - opt has the faults of Belady's MIN, computed by brute force
+#   - arc, 2q and lirs have fixed fault counts and keep a hot loop across scans that evict it from lru
+#   - the TLB hits: a fully associative one against the stack distances, and fixed per-level counts
+#   - the page walk cache hits: against a direct mapped cache written in awk, and fixed per-level counts
+#   - the metrics windows add up to the run, and their working set is the one counted in awk
+#   - pff and ws stay within the frames of the memory, and ws follows the working set
+# The simulator runs in a scratch directory with its own logs/, so nothing in the tree is touched
+set -u
+
+SIMULADOR="$(pwd)/simulador"
+TESTS="$(cd "$(dirname "$0")" && pwd)"
+WORK="$(mktemp -d)"
+trap 'rm -rf "$WORK"' EXIT
+mkdir "$WORK/logs"
+cp logs/*.log "$WORK/logs/"
+cd "$WORK" || exit 1
+
+checks=0
+failures=0
+
+fail() {
+    echo "FAIL: $*"
+    failures=$((failures + 1))
+}
+
+# the result lines of a simulation (the rest of the output has timings and paths)
+summary() {
+    "$SIMULADOR" "$@" | grep -E '^(Memory accesses|Page faults|Dirty pages|Process [0-9]+):'
+}
+
+generate() {
+    "$SIMULADOR" generate "$@" > /dev/null || fail "generate $*"
+}
+
+# traces: 20000 accesses over 64 to 256 pages of 4 KB, so the curves reach the point where everything fits
+generate zipf zipf.log 20000 4096 256 1 0.3
+generate loop loop.bin 20000 4096 200 2 0.3
+generate phases phases.bin 20000 4096 1024 3 0.3
+
+# mrc: the faults of every size up to 80 frames against lru on the dense table
+for trace in zipf.log loop.bin phases.bin lru.log; do
+    "$SIMULADOR" mrc "$trace" 4 80 | grep "^[0-9]" > mrc.csv
+    [ -s mrc.csv ] || fail "mrc $trace: empty curve"
+    while IFS=, read -r frames mem_size page_faults miss_ratio; do
+        checks=$((checks + 1))
+        lru=$(summary lru "$trace" 4 "$mem_size" 0 | sed -n 's/^Page faults: //p')
+        [ "$lru" = "$page_faults" ] || fail "mrc $trace $frames frames: $page_faults faults, lru has $lru"
+    done < mrc.csv
+done
+
+# scan variants: same victims, so the same accesses, faults and dirty pages
+for trace in zipf.log loop.bin phases.bin lru.log mfu.log; do
+    for algorithm in lru lfu mfu; do
+        for table_type in 0 1 2 3 4 5 6; do
+            for mem_size in 16 64 256; do
+                checks=$((checks + 1))
+                expected=$(summary $algorithm "$trace" 4 $mem_size $table_type)
+                actual=$(summary $algorithm:scan "$trace" 4 $mem_size $table_type)
+                [ -n "$expected" ] && [ "$expected" = "$actual" ] || fail "$algorithm:scan $trace 4 $mem_size $table_type differs from $algorithm"
+            done
+        done
+    done
+done
+
+# binary traces: the converted trace simulates exactly as the text one
+for trace in zipf lru mfu; do
+    "$SIMULADOR" convert $trace.log $trace.bin > /dev/null || fail "convert $trace.log"
+    for algorithm in lru opt clock; do
+        for table_type in 1 3; do
+            checks=$((checks + 1))
+            expected=$(summary $algorithm $trace.log 4 64 $table_type)
+            actual=$(summary $algorithm $trace.bin 4 64 $table_type)
+            [ -n "$expected" ] && [ "$expected" = "$actual" ] || fail "$algorithm $trace.bin 4 64 $table_type differs from the text trace"
+        done
+    done
+done
+
+# traces with pids: the binary formats 3 and 4 keep them, so both forms give the same processes
+generate uniform procs.log 20000 4096 256 4 0.3 3
+"$SIMULADOR" convert procs.log procs.bin > /dev/null || fail "convert procs.log"
+for mode in procs=global procs=local; do
+    for table_type in 1 3; do
+        checks=$((checks + 1))
+        expected=$(summary lru procs.log 4 64 $table_type $mode)
+        actual=$(summary lru procs.bin 4 64 $table_type $mode)
+        echo "$expected" | grep -q '^Process 3:' && [ "$expected" = "$actual" ] || fail "lru procs.bin 4 64 $table_type $mode differs from the text trace"
+    done
+done
+
+# debug logs: tests/debug/<trace>-<algorithm>-<table type>.log were written by the original simulator,
+# which printed the text log during the simulation (lru.log with 16 KB of memory, mfu.log with 8 KB)
+for expected in "$TESTS"/debug/*.log; do
+    name=$(basename "$expected" .log)
+    trace=${name%%-*}
+    rest=${name#*-}
+    algorithm=${rest%-*}
+    table_type=${rest##*-}
+    mem_size=16
+    [ "$trace" = mfu ] && mem_size=8
+    checks=$((checks + 1))
+    "$SIMULADOR" $algorithm $trace.log 4 $mem_size $table_type debug > /dev/null
+    "$SIMULADOR" decode debug.bin debug.log > /dev/null
+    cmp -s debug.log "$expected" || fail "decoded debug log of $algorithm $trace.log 4 $mem_size $table_type differs from $name.log"
+done
+
+# pids that start past the first chunk of a text trace (1 MB): the accesses before them are of process 0
+generate uniform late0.log 150000 4096 512 5 0.3
+generate uniform late1.log 30000 4096 512 6 0.3 2
+cat logs/late0.log logs/late1.log > logs/late.log
+"$SIMULADOR" convert late.log late.bin > /dev/null || fail "convert late.log"
+for table_type in 1 3; do
+    checks=$((checks + 1))
+    expected=$(summary lru late.bin 4 128 $table_type)
+    actual=$(summary lru late.log 4 128 $table_type)
+    echo "$actual" | grep -q '^Process 0: accesses 150000,' && [ "$expected" = "$actual" ] || fail "lru late.log 4 128 $table_type: late pids differ from the binary trace"
+done
+
+# 64-bit traces: refused where addresses are split in 32 bits, simulated by the tables of types 4 to 6
+generate uniform wide.bin 5000 1099511627776 274877906944 7 0.3
+generate uniform wide.log 5000 1099511627776 274877906944 7 0.3
+for trace in wide.bin wide.log; do
+    for command in "mrc $trace 4" "shards $trace 4 0.1" "lru $trace 4 64 1" "opt $trace 4 64 3"; do
+        checks=$((checks + 1))
+        "$SIMULADOR" $command | grep -q '^Page faults:\|^[0-9]' && fail "$command: 64-bit trace not refused"
+    done
+    checks=$((checks + 1))
+    [ "$(summary lru $trace 4 64 6 | sed -n 's/^Page faults: //p')" = 5000 ] || fail "lru $trace 4 64 6: expected a fault per access"
+done
+
+
+# refused traces read from a pipe that is still open: the run ends without waiting for the end of the input
+# (about 1.5 MB each, so the reader is blocked in read() after the first chunk)
+open_pipe() {
+    trace=$1
+    shift
+    checks=$((checks + 1))
+    { cat "logs/$trace"; exec sleep 60; } > open.fifo 2> /dev/null &
+    writer=$!
+    timeout 20 "$SIMULADOR" "$@" < open.fifo > /dev/null
+    [ $? -ne 124 ] || fail "$* < $trace: waits for the end of a pipe after refusing the trace"
+    kill $writer 2> /dev/null
+}
+mkfifo open.fifo
+generate uniform open.log 115000 4096 512 8 0.3 2
+generate uniform open-wide.log 100000 1099511627776 274877906944 9 0.3
+open_pipe open.log mrc - 4
+open_pipe open.log shards - 4 0.1
+open_pipe open-wide.log lru - 4 64 1
+
+
+# shards at rate 1 samples every page, so its curve is the exact one (the sampled pages are hashed)
+for trace in zipf.log loop.bin phases.bin; do
+    for budget in "" 4096; do
+        checks=$((checks + 1))
+        "$SIMULADOR" shards $trace 4 1 $budget compare | grep -q '^# mean absolute error: 0.000000, max absolute error: 0.000000$' ||
+            fail "shards $trace 4 1 $budget: differs from the exact curve at rate 1"
+    done
+done
+
+
+# opt against Belady's MIN written out by brute force: on a fault with the memory full, the resident page
+# used again farthest ahead (or never) is evicted, found by scanning all of them. With 4 KB pages the page
+# number is the address without its last 3 hex digits
+belady() {
+    awk -v frames="$2" '
+        NF >= 2 { page[++n] = substr($1, 1, length($1) - 3) }
+        END {
+            for (i = n; i >= 1; i--) {
+                next_use[i] = (page[i] in seen) ? seen[page[i]] : n + 1
+                seen[page[i]] = i
+            }
+            for (i = 1; i <= n; i++) {
+                if (!(page[i] in resident)) {
+                    faults++
+                    if (count == frames) {
+                        farthest = 0
+                        for (p in resident) if (resident[p] > farthest) { farthest = resident[p]; victim = p }
+                        delete resident[victim]
+                        count--
+                    }
+                    count++
+                }
+                resident[page[i]] = next_use[i]
+            }
+            print faults + 0
+        }' "logs/$1"
+}
+for trace in zipf.log lru.log mfu.log; do
+    for frames in 2 4 16 64; do
+        expected=$(belady $trace $frames)
+        for table_type in 0 1 6; do
+            checks=$((checks + 1))
+            actual=$(summary opt $trace 4 $((frames * 4)) $table_type | sed -n 's/^Page faults: //p')
+            [ "$expected" = "$actual" ] || fail "opt $trace 4 $((frames * 4)) $table_type: $actual faults, Belady has $expected"
+        done
+    done
+done
+
+
+# arc, 2q and lirs: fixed fault counts (the same on every table type), none below opt
+while read -r trace mem_size arc twoq lirs; do
+    opt=$(summary opt $trace 4 $mem_size 1 | sed -n 's/^Page faults: //p')
+    for algorithm in arc 2q lirs; do
+        case $algorithm in arc) expected=$arc ;; 2q) expected=$twoq ;; lirs) expected=$lirs ;; esac
+        for table_type in 0 1 6; do
+            checks=$((checks + 1))
+            actual=$(summary $algorithm $trace 4 $mem_size $table_type | sed -n 's/^Page faults: //p')
+            [ "$actual" = "$expected" ] && [ "$actual" -ge "$opt" ] ||
+                fail "$algorithm $trace 4 $mem_size $table_type: $actual faults, expected $expected (opt has $opt)"
+        done
+    done
+done <<END
+lru.log 8 31 31 24
+lru.log 12 31 24 17
+lru.log 16 10 16 10
+mfu.log 8 22 22 19
+mfu.log 12 15 15 12
+mfu.log 16 8 10 8
+zipf.log 16 13592 13908 13240
+zipf.log 64 7782 7658 7258
+zipf.log 256 64 64 64
+loop.bin 16 313 313 313
+loop.bin 64 313 313 313
+loop.bin 256 50 50 50
+phases.bin 16 9987 9994 9988
+phases.bin 64 9530 9499 9509
+phases.bin 256 7681 7722 7707
+END
+
+# scan resistance: a loop over 32 hot pages, broken by scans of 20 or 40 pages seen once, in 48 frames. lru
+# loses the hot pages to every scan; arc and lirs keep them (the faults of opt: the cold ones and one per
+# scanned page) and 2q keeps them after learning them once, from its ghosts
+for scan in 20 40; do
+    awk -v scan=$scan 'BEGIN {
+        for (round = 0; round < 100; round++) {
+            for (k = 0; k < 10; k++) for (p = 0; p < 32; p++) printf "%08x R\n", p * 4096
+            for (s = 0; s < scan; s++) printf "%08x R\n", (1000 + round * scan + s) * 4096
+        }
+    }' > logs/scan.log
+    best=$((32 + 100 * scan))
+    for algorithm in arc 2q lirs; do
+        checks=$((checks + 1))
+        actual=$(summary $algorithm scan.log 4 192 1 | sed -n 's/^Page faults: //p')
+        limit=$best
+        [ $algorithm = 2q ] && limit=$((best + 32))
+        [ "$actual" -ge $best ] && [ "$actual" -le $limit ] || fail "$algorithm scan.log 4 192 1 ($scan-page scans): $actual faults, expected $best to $limit"
+    done
+    checks=$((checks + 1))
+    [ "$(summary lru scan.log 4 192 1 | sed -n 's/^Page faults: //p')" -gt $((best + 32)) ] || fail "lru scan.log 4 192 1: the scans do not evict the hot pages"
+done
+
+
+# tlb: a fully associative lru TLB with the whole trace in memory hits the references whose stack
+# distance fits in it, the accesses minus the faults of lru with as many frames (from mrc)
+"$SIMULADOR" mrc zipf.log 4 64 | grep "^[0-9]" > mrc.csv
+for entries in 8 16 32; do
+    checks=$((checks + 1))
+    expected=$((20000 - $(grep "^$entries," mrc.csv | cut -d, -f3)))
+    actual=$("$SIMULADOR" lru zipf.log 4 1024 1 tlb=$entries | sed -n 's/^TLB L1 hit rate: .* (\([0-9]*\) hits.*/\1/p')
+    [ "$actual" = "$expected" ] || fail "lru zipf.log 4 1024 1 tlb=$entries: $actual hits, the stack distances give $expected"
+done
+
+# tlb: fixed hits and lookups of each level, the total and the context switches (the same on every table type)
+tlb_counts() {
+    "$SIMULADOR" "$@" | sed -n 's/^TLB \(L[12] \)\{0,1\}hit rate: .* (\([0-9]*\) hits, \([0-9]*\) lookups)$/\2\/\3/p; s/^Context switches: //p' | tr '\n' ' '
+}
+while read -r trace mem_size spec expected; do
+    for table_type in 1 3 6; do
+        checks=$((checks + 1))
+        actual=$(tlb_counts lru $trace 4 $mem_size $table_type $spec)
+        [ "$actual" = "$expected " ] || fail "lru $trace 4 $mem_size $table_type $spec: $actual, expected $expected"
+    done
+done <<END
+zipf.log 64 tlb=64x4,l2=256x8 4862/20000 6293/15138 11155/20000 0 (flush)
+zipf.log 64 tlb=32x4,random 4372/20000 4372/20000 0 (flush)
+zipf.log 64 tlb=16x2,random,l2=128x4 2559/20000 4751/17441 7310/20000 0 (flush)
+procs.log 256 tlb=64x4,flush=1000 18591/20000 18591/20000 22 (flush)
+procs.log 256 tlb=64x4,asid=1000 19808/20000 19808/20000 22 (asid)
+procs.log 256 tlb=32x4,random,asid=500,l2=128x8 10141/20000 9667/9859 19808/20000 42 (asid)
+END
+
+
+# pwc: on the two-level table with 4 KB pages the cache is direct mapped over the outer index, the top
+# 10 bits of the address (the first 3 hex digits over 4); its hits written out in awk
+generate uniform pwc.log 20000 4194304 262144 10 0.3
+generate zipf pwcz.log 20000 4194304 1048576 11 0.3
+generate uniform pwcp.log 20000 4194304 262144 12 0.3 3
+for trace in pwc.log pwcz.log; do
+    for entries in 1 4 32; do
+        checks=$((checks + 1))
+        expected=$(awk -v entries=$entries 'NF >= 2 {
+            value = 0
+            for (c = 1; c <= 3; c++) value = value * 16 + index("0123456789abcdef", substr($1, c, 1)) - 1
+            outer = int(value / 4)
+            slot = outer % entries
+            if ((slot in cached) && cached[slot] == outer) hits++
+            else cached[slot] = outer
+        } END { print hits + 0 }' logs/$trace)
+        actual=$("$SIMULADOR" lru $trace 4 256 1 pwc=$entries | sed -n 's/^Page walk cache.*(\([0-9]*\) hits.*/\1/p')
+        [ "$actual" = "$expected" ] || fail "lru $trace 4 256 1 pwc=$entries: $actual hits, a direct mapped cache has $expected"
+    done
+done
+
+# pwc: fixed hits and lookups of each cache and the page table references (three levels, behind a TLB, with
+# processes); the options of a run are joined by +
+while read -r trace table_type options expected; do
+    checks=$((checks + 1))
+    actual=$("$SIMULADOR" lru $trace 4 256 $table_type $(echo $options | tr '+' ' ') |
+        sed -n 's/^Page walk cache.*(\([0-9]*\) hits, \([0-9]*\) lookups)$/\1\/\2/p; s/^Page table references: //p' | tr '\n' ' ')
+    [ "$actual" = "$expected " ] || fail "lru $trace 4 256 $table_type $options: $actual, expected $expected"
+done <<END
+pwc.log 2 pwc 617/20000 19367/19383 39399
+pwcz.log 2 pwc=4 3434/20000 7122/16566 46010
+pwcz.log 1 tlb+pwc 10215/18031 25847
+pwcz.log 2 tlb=16+pwc=8 2858/18007 7256/15149 41049
+pwcp.log 1 pwc 10113/20000 29887
+pwcp.log 2 pwc 579/20000 19373/19421 39469
+END
+
+
+# metrics: the windows add up to the run (the 20000 accesses, the faults and the dirty pages), also with an
+# incomplete last window. The series counts every fault, so on the inverted table (type 3) it adds up to the
+# faults of type 0
+for trace in zipf.log phases.bin; do
+    for algorithm in lru clock opt arc; do
+        total=$(summary $algorithm $trace 4 64 0 | sed -n 's/^Page faults: //p; s/^Dirty pages: //p' | tr '\n' ' ')
+        for table_type in 0 1 3 6; do
+            for interval in 1000 3000; do
+                checks=$((checks + 1))
+                "$SIMULADOR" $algorithm $trace 4 64 $table_type metrics=metrics.csv,$interval > /dev/null
+                sums=$(awk -F, 'NR > 1 { accesses += $2; faults += $3; dirty += $5 } END { print accesses, faults, dirty }' metrics.csv)
+                [ "$sums " = "20000 $total" ] ||
+                    fail "$algorithm $trace 4 64 $table_type metrics=metrics.csv,$interval: the windows add up to $sums, the run has 20000 $total"
+            done
+        done
+    done
+done
+
+# metrics: the working set column is the number of distinct pages among the last τ accesses, counted in awk
+# (4 KB pages: the address without its last 3 hex digits)
+for tau in 100 500 5000; do
+    checks=$((checks + 1))
+    "$SIMULADOR" lru zipf.log 4 64 1 metrics=metrics.csv,1000,$tau > /dev/null
+    expected=$(awk -v tau=$tau 'NF >= 2 {
+        n++
+        last[substr($1, 1, length($1) - 3)] = n
+        if (n % 1000 == 0) {
+            pages = 0
+            for (p in last) if (last[p] > n - tau) pages++
+            print pages
+        }
+    }' logs/zipf.log)
+    [ "$(awk -F, 'NR > 1 { print $7 }' metrics.csv)" = "$expected" ] || fail "lru zipf.log 4 64 1 metrics=metrics.csv,1000,$tau: working set differs"
+done
+
+
+# alloc: pff and ws never use more frames than the memory has. The peak is within the limit, the average and
+# every sample (of the output and of metrics) within the peak; while the limit is not reached, the frames of
+# ws are the working set of metrics with the same τ
+for trace in zipf.log phases.bin procs.log; do
+    for algorithm in lru clock; do
+        for allocation in pff pff:0.005,0.05 ws ws:2000; do
+            tau=10000
+            [ $allocation = ws:2000 ] && tau=2000
+            for mem_size in 64 1024; do
+                checks=$((checks + 1))
+                run="$algorithm $trace 4 $mem_size 1 alloc=$allocation"
+                "$SIMULADOR" $run metrics=metrics.csv,1000,$tau > alloc.txt
+                limit=$((mem_size / 4))
+                awk -v limit=$limit '
+                    /^Peak memory: / { peak = $3 }
+                    /^Average memory: / { average = $3 }
+                    /^Frames over time/ { for (i = 6; i <= NF; i++) { split($i, sample, ":"); if (sample[2] > highest) highest = sample[2] } }
+                    END { exit !(peak >= 1 && peak <= limit && average <= peak && highest <= peak) }' alloc.txt &&
+                awk -F, -v peak=$(sed -n 's/^Peak memory: \([0-9]*\) .*/\1/p' alloc.txt) -v limit=$limit -v ws=${allocation%%:*} '
+                    NR > 1 && ($6 > peak || (ws == "ws" && peak < limit && $6 != $7)) { bad = 1 }
+                    END { exit bad }' metrics.csv ||
+                    fail "$run: frames beyond the limit of $limit or off the working set"
+            done
+        done
+    done
+done
+
+if [ $failures -ne 0 ]; then
+    echo "$failures of $checks checks failed"
+    exit 1
+fi
+echo "$checks checks passed"
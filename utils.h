@@ -10,4 +10,16 @@ uint32_t calculateOffset(int page_size);
 int count_bits_unsigned(uint32_t num);
 uint32_t make_mask(int bits);
 
+// virtual page number of an address (the page offset is dropped): used by the dense and inverted
+// address splits and by the miss-ratio curve modes
+static inline uint32_t page_number(uint32_t addr, uint32_t offset) {
+    return addr >> offset;
+}
+
+// virtual page number of an address in an address space of `address_size` bits: the bits above it
+// (such as the sign extension of x86-64 canonical addresses) are dropped
+static inline uint64_t virtual_page(uint64_t addr, uint32_t offset, uint32_t address_size) {
+    return (address_size >= 64 ? addr : addr & (((uint64_t) 1 << address_size) - 1)) >> offset;
+}
+
 #endif